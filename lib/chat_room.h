@@ -0,0 +1,148 @@
+#ifndef CHAT_ROOM_H
+#define CHAT_ROOM_H
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "client_registry.h"
+#include "history_store.h"
+#include "message_history.h"
+
+// Sala de chat com histórico e assinantes próprios.
+// Os assinantes são separados por shard: cada reator entrega só aos seus
+// clientes da sala, e salas diferentes não disputam nenhuma trava.
+template <typename Member>
+class ChatRoom {
+public:
+        using Subscribers = ClientRegistry<Member, 4>;
+
+        ChatRoom(std::string roomName, size_t shardCount, size_t historySize)
+            : name(std::move(roomName)), messages(historySize) {
+                for (size_t i = 0; i < std::max<size_t>(shardCount, 1); ++i) {
+                        perShard.push_back(std::make_unique<Subscribers>());
+                }
+        }
+
+        const std::string& getName() const {
+                return name;
+        }
+
+        MessageHistory& history() {
+                return messages;
+        }
+
+        const Subscribers& subscribers(size_t shard) const {
+                return *perShard[shard];
+        }
+
+        bool join(size_t shard, int id, std::shared_ptr<Member> member) {
+                return perShard[shard]->insert(id, std::move(member));
+        }
+
+        void leave(size_t shard, int id) {
+                perShard[shard]->erase(id);
+        }
+
+        size_t shardMembers(size_t shard) const {
+                return perShard[shard]->size();
+        }
+
+        size_t memberCount() const {
+                size_t total = 0;
+                for (const auto& subs : perShard) {
+                        total += subs->size();
+                }
+                return total;
+        }
+
+        size_t shardCount() const {
+                return perShard.size();
+        }
+
+private:
+        const std::string name;
+        MessageHistory messages;
+        std::vector<std::unique_ptr<Subscribers>> perShard;
+};
+
+// Diretório de salas por nome; criação sob demanda, até maxRooms salas.
+// Salas não são removidas (o histórico sobrevive a ficar vazia): o limite é
+// o que impede um cliente de esgotar memória e descritores com /join
+template <typename Member>
+class RoomDirectory {
+public:
+        using RoomPtr = std::shared_ptr<ChatRoom<Member>>;
+
+        // journal: log durável das salas (nullptr = histórico só em memória)
+        RoomDirectory(size_t shards, size_t historySize, size_t maxRooms, HistoryJournal* journal = nullptr)
+            : shardCount(shards), historySize(historySize), maxRooms(std::max<size_t>(maxRooms, 1)), journal(journal) {
+        }
+
+        RoomPtr find(const std::string& name) const {
+                std::shared_lock<std::shared_mutex> lock(roomsMutex);
+                auto it = rooms.find(name);
+                return it == rooms.end() ? nullptr : it->second;
+        }
+
+        // nullptr se a sala não existe e o limite de salas foi atingido
+        RoomPtr getOrCreate(const std::string& name) {
+                if (RoomPtr room = find(name)) {
+                        return room;
+                }
+
+                std::unique_lock<std::shared_mutex> lock(roomsMutex);
+                auto it = rooms.find(name);
+                if (it != rooms.end()) {
+                        return it->second;
+                }
+                if (rooms.size() >= maxRooms) {
+                        return nullptr;
+                }
+
+                RoomPtr room = std::make_shared<ChatRoom<Member>>(name, shardCount, historySize);
+                if (journal) {
+                        journal->open(name, [&](const std::shared_ptr<HistoryStore>& store) {
+                                room->history().attachStore(store);
+                        });
+                }
+                rooms.emplace(name, room);
+                return room;
+        }
+
+        size_t limit() const {
+                return maxRooms;
+        }
+
+        // Nome e número de membros de cada sala, em ordem alfabética
+        std::vector<std::pair<std::string, size_t>> list() const {
+                std::shared_lock<std::shared_mutex> lock(roomsMutex);
+                std::vector<std::pair<std::string, size_t>> result;
+                for (const auto& entry : rooms) {
+                        result.emplace_back(entry.first, entry.second->memberCount());
+                }
+                return result;
+        }
+
+        // Percorre todas as salas (ex.: somar o histórico)
+        template <typename Fn>
+        void forEach(Fn&& fn) const {
+                std::shared_lock<std::shared_mutex> lock(roomsMutex);
+                for (const auto& entry : rooms) {
+                        fn(*entry.second);
+                }
+        }
+
+private:
+        const size_t shardCount;
+        const size_t historySize;
+        const size_t maxRooms;
+        HistoryJournal* const journal;
+        mutable std::shared_mutex roomsMutex;
+        std::map<std::string, RoomPtr> rooms;
+};
+
+#endif // CHAT_ROOM_H
@@ -0,0 +1,145 @@
+#ifndef CLIENT_REGISTRY_H
+#define CLIENT_REGISTRY_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Registro de conexões indexado por id, no estilo RCU (copy-on-write).
+//
+// Leitores (broadcast, busca por id) carregam um snapshot imutável de um
+// std::atomic<std::shared_ptr> e iteram sem a trava dos escritores. A carga em
+// si não é lock-free na libstdc++: ela segura por alguns ns um bit de trava do
+// próprio ponteiro da faixa (não um mutex global), só o tempo de copiar o
+// ponteiro e incrementar a contagem. Escritores (entrada e saída de clientes)
+// copiam o snapshot da sua faixa, alteram a cópia e a publicam; o snapshot
+// antigo é liberado quando o último leitor o solta.
+// Custo: cada entrada ou saída copia o mapa e o vetor da faixa, O(N / Stripes)
+// com algumas alocações. Vale porque broadcasts são muito mais frequentes que
+// entradas; as faixas (ids % Stripes) limitam a cópia e a disputa entre escritores.
+template <typename T, size_t Stripes = 16>
+class ClientRegistry {
+public:
+        using Ptr = std::shared_ptr<T>;
+
+        struct Snapshot {
+                std::unordered_map<int, Ptr> byId;
+                std::vector<Ptr> members; // iteração contígua
+        };
+
+        ClientRegistry() {
+                for (auto& stripe : stripes) {
+                        stripe.current.store(std::make_shared<const Snapshot>());
+                }
+        }
+
+        // Delete copy
+        ClientRegistry(const ClientRegistry&) = delete;
+        ClientRegistry& operator=(const ClientRegistry&) = delete;
+
+        bool insert(int id, Ptr value) {
+                Stripe& stripe = stripeFor(id);
+                std::lock_guard<std::mutex> lock(stripe.writeMutex);
+
+                SnapshotPtr old = stripe.current.load();
+                if (old->byId.count(id)) {
+                        return false;
+                }
+
+                auto next = std::make_shared<Snapshot>(*old);
+                next->byId.emplace(id, value);
+                next->members.push_back(std::move(value));
+                stripe.current.store(SnapshotPtr(std::move(next)));
+
+                count++;
+                return true;
+        }
+
+        // Remove e devolve o elemento (nullptr se não existia)
+        Ptr erase(int id) {
+                Stripe& stripe = stripeFor(id);
+                std::lock_guard<std::mutex> lock(stripe.writeMutex);
+
+                SnapshotPtr old = stripe.current.load();
+                auto it = old->byId.find(id);
+                if (it == old->byId.end()) {
+                        return nullptr;
+                }
+                Ptr removed = it->second;
+
+                auto next = std::make_shared<Snapshot>(*old);
+                next->byId.erase(id);
+                for (auto& member : next->members) {
+                        if (member == removed) {
+                                member = std::move(next->members.back());
+                                next->members.pop_back();
+                                break;
+                        }
+                }
+                stripe.current.store(SnapshotPtr(std::move(next)));
+
+                count--;
+                return removed;
+        }
+
+        // Busca O(1) sem trava
+        Ptr find(int id) const {
+                SnapshotPtr snap = stripeFor(id).current.load();
+                auto it = snap->byId.find(id);
+                return it == snap->byId.end() ? nullptr : it->second;
+        }
+
+        // Percorre um snapshot de cada faixa; entradas e saídas concorrentes não bloqueiam
+        template <typename Fn>
+        void forEach(Fn&& fn) const {
+                for (const auto& stripe : stripes) {
+                        SnapshotPtr snap = stripe.current.load();
+                        for (const auto& member : snap->members) {
+                                fn(member);
+                        }
+                }
+        }
+
+        size_t size() const {
+                return count.load(std::memory_order_relaxed);
+        }
+
+        // Esvazia o registro e devolve o que havia nele
+        std::vector<Ptr> clear() {
+                std::vector<Ptr> removed;
+                for (auto& stripe : stripes) {
+                        std::lock_guard<std::mutex> lock(stripe.writeMutex);
+                        SnapshotPtr old = stripe.current.load();
+                        removed.insert(removed.end(), old->members.begin(), old->members.end());
+                        stripe.current.store(std::make_shared<const Snapshot>());
+                }
+                count -= removed.size();
+                return removed;
+        }
+
+private:
+        using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+        // Alinhado para que faixas vizinhas não compartilhem linha de cache
+        struct alignas(64) Stripe {
+                std::mutex writeMutex; // serializa apenas escritores desta faixa
+                std::atomic<SnapshotPtr> current;
+        };
+
+        Stripe& stripeFor(int id) {
+                return stripes[static_cast<size_t>(id) % Stripes];
+        }
+
+        const Stripe& stripeFor(int id) const {
+                return stripes[static_cast<size_t>(id) % Stripes];
+        }
+
+        std::array<Stripe, Stripes> stripes;
+        std::atomic<size_t> count{0};
+};
+
+#endif // CLIENT_REGISTRY_H
@@ -0,0 +1,186 @@
+#ifndef CORO_SOCKET_H
+#define CORO_SOCKET_H
+
+#include "event_loop.h"
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <sys/types.h>
+
+// Memória dos quadros de corrotina vivos (base do custo por conexão)
+struct CoroutineFrameStats {
+        size_t liveFrames;
+        size_t liveBytes;
+};
+
+CoroutineFrameStats coroutineFrameStats();
+
+// Corrotina "dispara e esquece": roda até o primeiro co_await na criação e
+// libera o próprio quadro ao terminar. Exceções não tratadas encerram o processo.
+struct DetachedTask {
+        struct promise_type {
+                DetachedTask get_return_object() noexcept {
+                        return {};
+                }
+                std::suspend_never initial_suspend() noexcept {
+                        return {};
+                }
+                std::suspend_never final_suspend() noexcept {
+                        return {};
+                }
+                void return_void() noexcept {
+                }
+                void unhandled_exception() noexcept {
+                        std::terminate();
+                }
+
+                // Contabiliza o tamanho de cada quadro alocado
+                static void* operator new(size_t size);
+                static void operator delete(void* frame, size_t size) noexcept;
+        };
+};
+
+// Socket não bloqueante registrado no EventLoop, com operações aguardáveis.
+// Não é dono do descritor: quem o cria mantém o SocketGuard no mesmo quadro
+// de corrotina, declarado antes, para que o fd só feche depois do registro sair.
+// Admite uma leitura (recv/accept) e uma escrita (send) pendentes por vez.
+class AsyncSocket {
+public:
+        // send() só completa com EPOLLOUT na máscara
+        AsyncSocket(EventLoop& loop, int fd, uint32_t events = EPOLLIN | EPOLLRDHUP | EPOLLET);
+        ~AsyncSocket();
+
+        // Delete copy
+        AsyncSocket(const AsyncSocket&) = delete;
+        AsyncSocket& operator=(const AsyncSocket&) = delete;
+
+        bool isValid() const {
+                return registered;
+        }
+
+        int fd() const {
+                return socketFd;
+        }
+
+        // Operação que tenta a syscall e, se ela bloquearia, suspende até o próximo evento
+        class Operation {
+        public:
+                bool await_ready() {
+                        return attempt();
+                }
+                void await_suspend(std::coroutine_handle<> handle);
+                ssize_t await_resume() const {
+                        return result;
+                }
+
+        protected:
+                Operation(AsyncSocket& socket, bool write) : socket(socket), write(write) {
+                }
+
+                // true quando terminou (com sucesso ou erro); false se ainda bloquearia
+                virtual bool attempt() = 0;
+
+                AsyncSocket& socket;
+                ssize_t result = -1;
+
+        private:
+                friend class AsyncSocket;
+                const bool write;
+                std::coroutine_handle<> waiting;
+        };
+
+        // recv(): bytes lidos, 0 em EOF ou -1 em erro (errno preservado)
+        class RecvOperation : public Operation {
+        public:
+                RecvOperation(AsyncSocket& socket, char* buffer, size_t length)
+                    : Operation(socket, false), buffer(buffer), length(length) {
+                }
+
+        private:
+                bool attempt() override;
+                char* buffer;
+                size_t length;
+        };
+
+        // send(): envia tudo; retorna o total ou -1 em erro
+        class SendOperation : public Operation {
+        public:
+                SendOperation(AsyncSocket& socket, std::string_view data) : Operation(socket, true), data(data) {
+                }
+
+        private:
+                bool attempt() override;
+                std::string_view data;
+                size_t sent = 0;
+        };
+
+        // readable(): espera haver dados sem reservar buffer (1, ou -1 se cancelada).
+        // Não faz syscall: usa o que o último recv() e os eventos já disseram
+        class ReadableOperation : public Operation {
+        public:
+                explicit ReadableOperation(AsyncSocket& socket) : Operation(socket, false) {
+                }
+
+        private:
+                bool attempt() override;
+        };
+
+        // accept(): novo fd já não bloqueante e com CLOEXEC, ou -1 em erro
+        class AcceptOperation : public Operation {
+        public:
+                explicit AcceptOperation(AsyncSocket& socket) : Operation(socket, false) {
+                }
+
+        private:
+                bool attempt() override;
+        };
+
+        RecvOperation recv(char* buffer, size_t length) {
+                return RecvOperation(*this, buffer, length);
+        }
+
+        ReadableOperation readable() {
+                return ReadableOperation(*this);
+        }
+
+        SendOperation send(std::string_view data) {
+                return SendOperation(*this, data);
+        }
+
+        AcceptOperation accept() {
+                return AcceptOperation(*this);
+        }
+
+        // EPOLLOUT sem send() pendente (ex.: fila de saída drenada fora da corrotina)
+        void onWritable(std::function<void()> handler) {
+                writableHandler = std::move(handler);
+        }
+
+        // Completa as operações pendentes com ECANCELED e retoma as corrotinas.
+        // A corrotina retomada pode destruir este objeto: nada o usa depois da chamada
+        void cancel();
+
+private:
+        void onEvent(uint32_t events);
+        static void complete(Operation*& slot);
+
+        EventLoop& loop;
+        const int socketFd;
+        bool registered;
+        // Falso quando o último recv() esvaziou o socket; o próximo EPOLLIN religa.
+        // Começa falso: o EPOLL_CTL_ADD já reporta dados que chegaram antes do registro
+        bool mayHaveData = false;
+        // EPOLLRDHUP/HUP já visto: o EOF (ou erro) ainda precisa ser lido por um recv()
+        bool peerClosed = false;
+        Operation* reader = nullptr;
+        Operation* writer = nullptr;
+        std::function<void()> writableHandler;
+        // Falso após a destruição: o despacho de eventos para de tocar no objeto
+        std::shared_ptr<bool> alive = std::make_shared<bool>(true);
+};
+
+#endif // CORO_SOCKET_H
@@ -0,0 +1,64 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <sys/epoll.h>
+#include <unordered_map>
+#include <vector>
+#include "timer_wheel.h"
+
+// Coloca o descritor em modo não bloqueante (necessário para epoll edge-triggered)
+bool setNonBlocking(int fd);
+
+// Laço de eventos baseado em epoll: um único thread atende vários sockets.
+// Os temporizadores da roda disparam na mesma thread, depois dos eventos de E/S
+class EventLoop {
+public:
+        using Handler = std::function<void(uint32_t events)>;
+
+        explicit EventLoop(size_t maxEvents = 256);
+        ~EventLoop();
+
+        // Delete copy
+        EventLoop(const EventLoop&) = delete;
+        EventLoop& operator=(const EventLoop&) = delete;
+
+        bool isValid() const {
+                return epollFd >= 0;
+        }
+
+        // Registra fd com a máscara de eventos (ex.: EPOLLIN | EPOLLET) e seu handler
+        bool add(int fd, uint32_t events, Handler handler);
+
+        // Altera a máscara de eventos de um fd já registrado
+        bool modify(int fd, uint32_t events);
+
+        // Remove o fd do epoll (não fecha o descritor)
+        void remove(int fd);
+
+        // Aguarda até timeoutMs (ou até o próximo temporizador, se vier antes),
+        // despacha os handlers prontos e dispara os temporizadores vencidos.
+        // Retorna o número de eventos tratados ou -1 em erro (EINTR conta como 0)
+        int poll(int timeoutMs);
+
+        // Temporizadores do laço: só a thread que chama poll() pode usá-los
+        TimerWheel& timers() {
+                return wheel;
+        }
+
+        // Número de descritores registrados
+        size_t size() const {
+                return handlers.size();
+        }
+
+private:
+        int epollFd;
+        // shared_ptr permite que um handler remova o próprio fd durante o despacho
+        std::unordered_map<int, std::shared_ptr<Handler>> handlers;
+        std::vector<epoll_event> readyEvents;
+        TimerWheel wheel;
+};
+
+#endif // EVENT_LOOP_H
@@ -0,0 +1,161 @@
+#ifndef HISTORY_STORE_H
+#define HISTORY_STORE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Mensagem lida de volta do disco
+struct StoredMessage {
+        uint64_t sequence;     // sequência da mensagem na sala
+        int64_t timestampNs;   // system_clock desde a época
+        std::string_view line; // linha como foi enviada (termina em '\n'); válida só durante o callback
+};
+
+// Log de histórico de uma sala: arquivos de segmento só de acréscimo
+// (NNNNNNNNNNNNNNNN.seg) em um diretório próprio.
+// append() só copia o registro para um buffer em memória; a thread do
+// HistoryJournal grava o lote e faz um único fdatasync por intervalo
+// (group commit), então quem faz o broadcast nunca espera pelo disco.
+class HistoryStore {
+public:
+        HistoryStore(std::string directory, size_t segmentBytes);
+        ~HistoryStore();
+
+        // Delete copy
+        HistoryStore(const HistoryStore&) = delete;
+        HistoryStore& operator=(const HistoryStore&) = delete;
+
+        // Entrega as últimas 'count' mensagens em ordem. Mapeia (mmap) só os
+        // segmentos do fim necessários para cobrir a janela, do mais novo para
+        // o mais antigo; um registro incompleto no fim (queda no meio da
+        // escrita) é cortado do arquivo. Deve ser chamado antes do primeiro append()
+        size_t recover(size_t count, const std::function<void(const StoredMessage&)>& fn);
+
+        // Copia o registro para o lote pendente; false se o lote passou do
+        // limite (disco lento demais) e o registro foi descartado
+        bool append(uint64_t sequence, int64_t timestampNs, std::string_view line);
+
+        // Grava o lote pendente e faz fdatasync (thread do journal). Se a escrita
+        // ou o fdatasync falhar, o segmento volta ao último registro inteiro e o
+        // lote volta ao pendente para a próxima rodada
+        void commit();
+
+        // Contadores desta sala
+        uint64_t appendedCount() const {
+                return appended.load(std::memory_order_relaxed);
+        }
+        uint64_t droppedCount() const {
+                return dropped.load(std::memory_order_relaxed);
+        }
+        uint64_t syncCount() const {
+                return syncs.load(std::memory_order_relaxed);
+        }
+        uint64_t bytesWritten() const {
+                return written.load(std::memory_order_relaxed);
+        }
+        uint64_t errorCount() const {
+                return errors.load(std::memory_order_relaxed);
+        }
+        // Segmentos mapeados pelo recover()
+        size_t segmentsRead() const {
+                return recoveredSegments;
+        }
+
+private:
+        // Varre um segmento mapeado; devolve o fim do último registro válido
+        static size_t scanSegment(const char* data, size_t size, std::vector<size_t>& offsets);
+
+        std::string segmentPath(uint64_t number) const;
+        bool openSegment(uint64_t number);
+        std::vector<uint64_t> listSegments() const;
+        void restoreBatch();
+
+        const std::string directory;
+        const size_t segmentBytes;
+
+        // Lote ainda não gravado; trocado com 'writing' a cada commit
+        std::mutex pendingMutex;
+        std::string pending;
+        std::string writing; // só a thread do journal usa
+
+        // Segmento ativo: o recover() o abre antes de o HistoryJournal registrar o
+        // log, e daí em diante só a thread do journal o usa (sem trava).
+        // Fechado depois de IDLE_CLOSE sem gravar e reaberto no próximo lote:
+        // salas quietas não seguram descritores
+        int activeFd = -1;
+        bool parked = false;
+        std::chrono::steady_clock::time_point lastWrite;
+        uint64_t activeNumber = 0;
+        size_t activeSize = 0;
+        size_t recoveredSegments = 0;
+
+        std::atomic<uint64_t> appended{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> syncs{0};
+        std::atomic<uint64_t> written{0};
+        std::atomic<uint64_t> errors{0};
+};
+
+// Dono dos logs de todas as salas (um subdiretório por sala) e da thread
+// de group commit que os descarrega a cada intervalo
+class HistoryJournal {
+public:
+        HistoryJournal(std::string directory, std::chrono::milliseconds commitInterval,
+                       size_t segmentBytes = 4 * 1024 * 1024);
+        ~HistoryJournal();
+
+        // Delete copy
+        HistoryJournal(const HistoryJournal&) = delete;
+        HistoryJournal& operator=(const HistoryJournal&) = delete;
+
+        bool isOpen() const {
+                return ready;
+        }
+
+        // Log da sala 'room' (nome já validado: letras, dígitos, '-' e '_').
+        // 'recover' roda antes de o log entrar na rodada de group commit: a
+        // thread do journal só toca o segmento ativo depois do recover()
+        std::shared_ptr<HistoryStore> open(const std::string& room,
+                                           const std::function<void(const std::shared_ptr<HistoryStore>&)>& recover);
+
+        // Salas que já têm log no diretório (para recriá-las na partida)
+        std::vector<std::string> existingRooms() const;
+
+        // Somas de todas as salas
+        struct Stats {
+                uint64_t appended;
+                uint64_t dropped;
+                uint64_t syncs;
+                uint64_t bytesWritten;
+                uint64_t errors;
+        };
+        Stats stats() const;
+
+private:
+        void run();
+
+        const std::string directory;
+        const std::chrono::milliseconds commitInterval;
+        const size_t segmentBytes;
+        bool ready = false;
+
+        mutable std::mutex storesMutex;
+        std::vector<std::shared_ptr<HistoryStore>> stores;
+
+        std::mutex stopMutex;
+        std::condition_variable stopCondition;
+        bool stopping = false;
+        std::thread committer;
+};
+
+#endif // HISTORY_STORE_H
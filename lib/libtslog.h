@@ -1,31 +1,144 @@
 #include "logEntry.h"
+#include "log_events.h"
+#include "log_record.h"
 #include <atomic>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <type_traits>
 #ifndef LIBTSLOG_H
 #define LIBTSLOG_H
-#define MAX_LOG_QUEUE_SIZE 1000
+#define LOG_RING_CAPACITY 1024   // Potência de 2
+#define LOG_MAX_ARGS 448         // Bytes de argumentos por registro; strings maiores são truncadas
+#define LOG_WRITE_BATCH 256      // Registros coalescidos por escrita no arquivo
+
+// Nível mínimo compilado (0=debug, 1=info, 2=warn, 3=error): chamadas abaixo
+// dele somem do binário. Builds normais usam info; 'make debug' liga o debug
+#ifndef TSLOG_MIN_LEVEL
+#define TSLOG_MIN_LEVEL 1
+#endif
+
+// Texto: o escritor formata cada registro. Binário: grava os registros crus
+// (formato em log_record.h) e a formatação fica para o log_decoder
+enum class LogOutput {
+        Text,
+        Binary
+};
 
 class ThreadSafeLogger {
 public:
         ThreadSafeLogger();
         virtual ~ThreadSafeLogger();
         void log(const std::string &message);
-        void initialize(const std::string &filename);
+        void initialize(const std::string &filename, LogOutput output = LogOutput::Text);
         void shutdown();
-        std::queue<LogEntry> logQueue;
-        std::mutex logMutex;
+
+        // Registra um evento do catálogo (log_events.h) com argumentos crus:
+        // inteiros e strings são copiados para o slot e só são formatados
+        // depois (escritor em modo texto ou log_decoder)
+        template<LogLevel Level, typename... Args>
+        void logAt(LogEvent event, const Args &...args) {
+                if constexpr (static_cast<int>(Level) >= TSLOG_MIN_LEVEL) {
+                        if (Level < minLevel.load(std::memory_order_relaxed)) {
+                                return;
+                        }
+
+                        size_t pos;
+                        LogSlot *slot = acquireSlot(pos);
+                        if (slot == nullptr) {
+                                return;
+                        }
+
+                        slot->event = static_cast<uint16_t>(event);
+                        slot->level = static_cast<uint8_t>(Level);
+                        slot->argCount = 0;
+                        slot->length = 0;
+                        (encodeArg(*slot, args), ...);
+                        publishSlot(*slot, pos);
+                }
+        }
+
+        template<typename... Args>
+        void debug(LogEvent event, const Args &...args) { logAt<LogLevel::Debug>(event, args...); }
+        template<typename... Args>
+        void info(LogEvent event, const Args &...args) { logAt<LogLevel::Info>(event, args...); }
+        template<typename... Args>
+        void warn(LogEvent event, const Args &...args) { logAt<LogLevel::Warn>(event, args...); }
+        template<typename... Args>
+        void error(LogEvent event, const Args &...args) { logAt<LogLevel::Error>(event, args...); }
+
+        // Filtro em tempo de execução, acima do mínimo compilado
+        void setMinLevel(LogLevel level) { minLevel.store(level, std::memory_order_relaxed); }
+
+        // Entradas descartadas com o anel cheio e argumentos truncados
+        uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+        uint64_t truncatedCount() const { return truncated.load(std::memory_order_relaxed); }
 
 private:
+        // Slot pré-alocado do anel; o número de sequência indica se está livre
+        // (== posição) ou publicado (== posição + 1), no esquema de Vyukov
+        struct alignas(64) LogSlot {
+                std::atomic<size_t> sequence;
+                int64_t timestampNs;
+                uint64_t threadId;
+                uint16_t event;
+                uint8_t level;
+                uint8_t argCount;
+                uint16_t length;
+                char args[LOG_MAX_ARGS];
+        };
+
+        static void keepOlderVersion(const std::string &filename);
+        LogSlot *acquireSlot(size_t &pos);
+        void publishSlot(LogSlot &slot, size_t pos);
+
+        template<typename T>
+        void encodeArg(LogSlot &slot, const T &value) {
+                if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+                        if (slot.length + 9 > LOG_MAX_ARGS) {
+                                truncated.fetch_add(1, std::memory_order_relaxed);
+                                return;
+                        }
+                        int64_t raw = static_cast<int64_t>(value);
+                        slot.args[slot.length] = LOG_ARG_INT;
+                        std::memcpy(slot.args + slot.length + 1, &raw, sizeof(raw));
+                        slot.length += 9;
+                        slot.argCount++;
+                } else {
+                        encodeString(slot, std::string_view(value));
+                }
+        }
+
+        void encodeString(LogSlot &slot, std::string_view text);
+
+        bool tryPop(LogEntry &entry);
+        size_t drainBatch(std::string &out);
         void logWriterFunc();
+
+        std::unique_ptr<LogSlot[]> ring;
+        alignas(64) std::atomic<size_t> enqueuePos{0};
+        alignas(64) size_t dequeuePos = 0; // Só a thread escritora avança
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> truncated{0};
+        std::atomic<LogLevel> minLevel{LogLevel::Debug};
+
+        // Acordar a escritora só quando ela estiver dormindo
+        std::atomic<bool> writerSleeping{false};
+        std::mutex wakeMutex;
+        std::condition_variable logCondition;
+
         std::thread logThread;
         std::ofstream logFile;
-        std::condition_variable logCondition;
+        LogOutput output = LogOutput::Text;
+        LogFormatter formatter; // Só a thread escritora usa
         std::atomic<bool> running;
 };
-#endif
\ No newline at end of file
+#endif
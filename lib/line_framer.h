@@ -0,0 +1,57 @@
+#ifndef LINE_FRAMER_H
+#define LINE_FRAMER_H
+
+#include <cstddef>
+#include <string_view>
+
+// Framer de fluxo TCP para mensagens terminadas em '\n'.
+// O recv() escreve direto no buffer interno e cada leitura pode render
+// várias mensagens; bytes de uma linha incompleta ficam para a próxima.
+// O buffer vem do BufferPool e volta a ele no destrutor: conexões novas
+// reaproveitam a memória de recepção das que fecharam.
+class LineFramer {
+public:
+        explicit LineFramer(size_t maxLineLength = 64 * 1024);
+        ~LineFramer();
+
+        // Delete copy
+        LineFramer(const LineFramer&) = delete;
+        LineFramer& operator=(const LineFramer&) = delete;
+
+        // Retorna área contígua com pelo menos minSpace bytes livres para o recv()
+        char* prepareWrite(size_t minSpace);
+
+        // Confirma n bytes escritos na área devolvida por prepareWrite()
+        void commitWrite(size_t n);
+
+        // Copia bytes para o buffer (para quem não lê direto nele)
+        void append(const char* data, size_t n);
+
+        // Extrai a próxima linha completa, sem '\n' e sem '\r' final.
+        // A view é válida até a próxima chamada de prepareWrite()/append().
+        // Linhas maiores que maxLineLength são entregues em pedaços desse tamanho.
+        bool nextLine(std::string_view& line);
+
+        // Bytes recebidos e ainda não consumidos
+        size_t buffered() const {
+                return writePos - readPos;
+        }
+
+        // Acesso cru para protocolos com outro framing (ex.: quadros binários)
+        std::string_view pending() const {
+                return std::string_view(buffer + readPos, writePos - readPos);
+        }
+
+        // Descarta n bytes do início dos dados pendentes
+        void consume(size_t n);
+
+private:
+        char* buffer = nullptr;
+        size_t capacity = 0;
+        size_t readPos = 0;  // início dos bytes não consumidos
+        size_t scanPos = 0;  // até onde já se procurou '\n' (evita rescan quadrático)
+        size_t writePos = 0; // fim dos bytes válidos
+        const size_t maxLineLength;
+};
+
+#endif // LINE_FRAMER_H
@@ -1,12 +1,23 @@
-#include <iostream>
+#include <cstdint>
 #include <string>
-#include <thread>
 #ifndef LOGENTRY_H
 #define LOGENTRY_H
+// Argumentos codificados: tag de 1 byte seguida do valor
+#define LOG_ARG_INT 'i' // int64, ordem de bytes do host
+#define LOG_ARG_STR 's' // u16 tamanho + bytes
+enum class LogLevel : uint8_t {
+        Debug,
+        Info,
+        Warn,
+        Error
+};
 class LogEntry {
 public:
-        std::chrono::system_clock::time_point timestamp;
-        std::thread::id threadId;
-        std::string message;
+        int64_t timestampNs = 0; // Nanosegundos desde a época (system_clock)
+        uint64_t threadId = 0;   // Id da thread no kernel (gettid)
+        uint16_t event = 0;      // LogEvent
+        LogLevel level = LogLevel::Info;
+        uint8_t argCount = 0;
+        std::string args;
 };
-#endif
\ No newline at end of file
+#endif
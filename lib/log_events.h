@@ -0,0 +1,66 @@
+#ifndef LOG_EVENTS_H
+#define LOG_EVENTS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Catálogo de eventos do log binário: o registro guarda só o id e os
+// argumentos; o texto é montado depois, pelo escritor em modo texto ou
+// pelo log_decoder. Cada "{}" consome o próximo argumento.
+// Novos eventos entram SEMPRE no fim, para manter logs antigos decodificáveis.
+#define TSLOG_EVENTS(X) \
+        X(Text, "{}") \
+        X(ServerStopping, "Servidor encerrando...") \
+        X(ServerStopped, "Servidor encerrado") \
+        X(ConsoleUnavailable, "Entrada padrão indisponível - executando sem console") \
+        X(ServerStarting, "Servidor iniciando na porta {}") \
+        X(ServerListening, "Servidor ouvindo conexões na porta {}") \
+        X(MainLoopStopped, "Loop principal do servidor encerrado") \
+        X(Error, "ERRO: {}") \
+        X(ShardError, "ERRO: {} do shard {}") \
+        X(ReactorActive, "Modo reator ativo com {} shard(s)") \
+        X(ClientConnected, "Cliente {} conectado (socket: {})") \
+        X(ClientConnectedShard, "Cliente {} conectado (socket: {}, shard: {})") \
+        X(ClientDisconnected, "Cliente {} desconectado") \
+        X(ClientThreadStarted, "Thread iniciada para Cliente {}") \
+        X(BinaryNegotiated, "Cliente {} negociou protocolo binário") \
+        X(InvalidFrame, "Cliente {} enviou quadro inválido") \
+        X(RoomJoined, "Cliente {} entrou na sala {}") \
+        X(MessageReceived, "Mensagem recebida do Cliente {}: {}") \
+        X(MessageRelayed, "Mensagem retransmitida do Cliente {} ({} bytes)") \
+        X(HistorySent, "Histórico enviado ao cliente {}") \
+        X(SlowConsumerDisconnected, "Cliente {} desconectado por fila de saída cheia") \
+        X(AdminListening, "Endpoint de métricas em 127.0.0.1:{}") \
+        X(PoolStarted, "Pool de workers ativo com {} thread(s)") \
+        X(HistoryRecovered, "Histórico da sala {} recuperado do disco: {} mensagens em {} µs") \
+        X(RoomLimitReached, "Limite de {} salas atingido; sala '{}' não criada") \
+        X(DirectMessage, "Mensagem privada do Cliente {} para o Cliente {} ({} bytes)") \
+        X(IdleDisconnected, "Cliente {} desconectado por ociosidade ({} s sem dados)")
+
+enum class LogEvent : uint16_t {
+#define TSLOG_EVENT_ENUM(name, format) name,
+        TSLOG_EVENTS(TSLOG_EVENT_ENUM)
+#undef TSLOG_EVENT_ENUM
+        Count
+};
+
+// Texto de formatação do evento (nullptr para ids desconhecidos)
+inline const char* logEventFormat(uint16_t id) {
+        static const char* const formats[] = {
+#define TSLOG_EVENT_FORMAT(name, format) format,
+                TSLOG_EVENTS(TSLOG_EVENT_FORMAT)
+#undef TSLOG_EVENT_FORMAT
+        };
+        return id < static_cast<uint16_t>(LogEvent::Count) ? formats[id] : nullptr;
+}
+
+inline const char* logEventName(uint16_t id) {
+        static const char* const names[] = {
+#define TSLOG_EVENT_NAME(name, format) #name,
+                TSLOG_EVENTS(TSLOG_EVENT_NAME)
+#undef TSLOG_EVENT_NAME
+        };
+        return id < static_cast<uint16_t>(LogEvent::Count) ? names[id] : nullptr;
+}
+
+#endif // LOG_EVENTS_H
@@ -0,0 +1,48 @@
+#ifndef LOG_RECORD_H
+#define LOG_RECORD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include "logEntry.h"
+
+// Formato binário do libtslog (ordem de bytes do host; lido na mesma máquina):
+//   arquivo:  "TSLB" | u8 versão | 3 bytes reservados
+//   registro: u16 tamanho total | u16 evento | u8 nível | u8 nº de args |
+//             u16 reservado | i64 timestamp ns | u64 thread | args
+// Versão 1: o byte do nível era reservado (sempre 0); lido como Info
+constexpr char LOG_FILE_MAGIC[] = {'T', 'S', 'L', 'B'};
+constexpr uint8_t LOG_FILE_VERSION = 2;
+constexpr size_t LOG_FILE_HEADER_SIZE = 8;
+constexpr size_t LOG_RECORD_HEADER_SIZE = 24;
+
+enum class RecordStatus {
+        Complete,
+        Incomplete,
+        Invalid
+};
+
+void appendLogFileHeader(std::string& out);
+// Versão do arquivo (1..LOG_FILE_VERSION), ou 0 se não é um log do libtslog
+uint8_t logFileVersion(std::string_view data);
+
+void appendLogRecord(std::string& out, const LogEntry& entry);
+RecordStatus readLogRecord(std::string_view data, LogEntry& entry, size_t& consumed,
+                           uint8_t version = LOG_FILE_VERSION);
+
+const char* logLevelName(LogLevel level);
+bool parseLogLevel(std::string_view text, LogLevel& level);
+
+// Formata registros como texto; mantém em cache o último segundo formatado
+class LogFormatter {
+public:
+        void format(const LogEntry& entry, std::string& out);
+
+private:
+        time_t lastSecond = -1;
+        std::string lastStamp;
+};
+
+#endif // LOG_RECORD_H
@@ -0,0 +1,138 @@
+#ifndef MEMORY_POOL_H
+#define MEMORY_POOL_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Blocos reaproveitados por classe de tamanho (potências de dois de 64 B a 128 KiB).
+// Cada thread guarda um pequeno estoque por classe e só toca o depósito global
+// (com trava) para reabastecer ou devolver metade do estoque de uma vez. Assim
+// o buffer criado em um shard e liberado em outro volta ao uso sem ir ao heap.
+// Pedidos acima da maior classe vão direto ao heap.
+class BufferPool {
+public:
+        static constexpr size_t MIN_CLASS_SIZE = 64;
+        static constexpr size_t CLASS_COUNT = 12;
+        static constexpr size_t MAX_CLASS_SIZE = MIN_CLASS_SIZE << (CLASS_COUNT - 1);
+
+        struct Stats {
+                uint64_t requests;  // pedidos (aproximado: cada thread publica em lotes)
+                uint64_t misses;    // pedidos atendidos pelo heap
+                size_t depotBytes;  // bytes parados no depósito global
+        };
+
+        // Instância do processo; nunca é destruída porque os estoques das
+        // threads a usam até o fim de cada thread
+        static BufferPool& instance();
+
+        // Bloco com pelo menos 'size' bytes, alinhado como o operator new
+        void* allocate(size_t size);
+
+        // 'size' deve ser o mesmo valor passado a allocate()
+        void release(void* block, size_t size);
+
+        Stats stats() const;
+
+        // Índice da classe de 'size' (CLASS_COUNT se não couber em nenhuma)
+        static size_t classIndex(size_t size);
+
+        static size_t classSize(size_t index) {
+                return MIN_CLASS_SIZE << index;
+        }
+
+private:
+        friend struct BufferPoolThreadCache;
+
+        BufferPool() = default;
+
+        struct Depot {
+                std::mutex mutex;
+                std::vector<void*> blocks;
+        };
+
+        std::array<Depot, CLASS_COUNT> depots;
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<size_t> depotBytes{0};
+};
+
+// Arena de objetos de tamanho fixo: fatias de 64 KiB divididas em slots,
+// com lista livre intrusiva. Os slots voltam para a lista e nunca ao heap,
+// então a memória fica limitada ao pico de objetos vivos.
+class SlabArena {
+public:
+        explicit SlabArena(size_t objectSize);
+
+        // Delete copy
+        SlabArena(const SlabArena&) = delete;
+        SlabArena& operator=(const SlabArena&) = delete;
+
+        void* allocate();
+        void release(void* slot);
+
+        // Totais de todas as arenas: pedidos e slots que não vieram da lista livre
+        static uint64_t totalRequests();
+        static uint64_t totalMisses();
+
+private:
+        static constexpr size_t SLAB_BYTES = 64 * 1024;
+
+        struct FreeSlot {
+                FreeSlot* next;
+        };
+
+        const size_t slotSize;
+        std::mutex mutex;
+        FreeSlot* freeList = nullptr;
+        char* carveNext = nullptr; // próximo slot ainda não usado da fatia atual
+        char* carveEnd = nullptr;
+};
+
+// Uma arena por tamanho de objeto, criada no primeiro uso e nunca destruída
+template <size_t Size, size_t Align>
+SlabArena& slabArenaFor() {
+        static_assert(Align <= alignof(std::max_align_t), "alinhamento acima do garantido pelas fatias");
+        static SlabArena* arena = new SlabArena(Size);
+        return *arena;
+}
+
+// Alocador padrão sobre as arenas: com std::allocate_shared o objeto e o
+// bloco de controle do shared_ptr saem de um único slot
+template <typename T>
+class SlabAllocator {
+public:
+        using value_type = T;
+
+        SlabAllocator() noexcept = default;
+
+        template <typename U>
+        SlabAllocator(const SlabAllocator<U>&) noexcept {
+        }
+
+        T* allocate(size_t n) {
+                if (n != 1) {
+                        return static_cast<T*>(::operator new(n * sizeof(T)));
+                }
+                return static_cast<T*>(slabArenaFor<sizeof(T), alignof(T)>().allocate());
+        }
+
+        void deallocate(T* p, size_t n) noexcept {
+                if (n != 1) {
+                        ::operator delete(p);
+                        return;
+                }
+                slabArenaFor<sizeof(T), alignof(T)>().release(p);
+        }
+
+        template <typename U>
+        bool operator==(const SlabAllocator<U>&) const noexcept {
+                return true;
+        }
+};
+
+#endif // MEMORY_POOL_H
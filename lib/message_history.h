@@ -2,35 +2,110 @@
 #define MESSAGE_HISTORY_H
 
 #include <chrono>
-#include <deque>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
+#include "history_store.h"
+#include "ring_buffer.h"
+#include "search_index.h"
+#include "shared_buffer.h"
 
 struct HistoryEntry {
-        std::string message;
+        uint64_t sequence;    // Número da mensagem na sala: 1, 2, 3... sem buracos
+        SharedBuffer message; // Linha compartilhada com o broadcast (termina em '\n')
         std::chrono::system_clock::time_point timestamp;
         int senderSocket;
+        SharedBuffer rendered; // "[HH:MM:SS] mensagem" (sem '\n'), montada uma vez na inserção
+};
+
+// Linha renderizada com a sequência (retomada e quadros History)
+struct HistoryLine {
+        uint64_t sequence;
+        std::string text; // "[HH:MM:SS] mensagem", sem '\n'
+};
+
+// Resultado de since(): o que o cliente perdeu depois de uma sequência
+struct HistorySlice {
+        uint64_t firstAvailable = 0; // menor sequência ainda guardada (0 = histórico vazio)
+        uint64_t last = 0;           // última sequência atribuída
+        std::vector<HistoryLine> lines;
+
+        // Sequências depois de 'after' que já saíram do histórico (lacuna), se houver
+        bool hasGap(uint64_t after) const {
+                return firstAvailable > 0 && after + 1 < firstAvailable;
+        }
 };
 
 class MessageHistory {
 private:
-        std::deque<HistoryEntry> messages;
+        // Sequências contíguas: a entrada de sequência s fica em messages[s - front().sequence]
+        RingBuffer<HistoryEntry> messages;
+        uint64_t nextSequence = 1;
         mutable std::mutex historyMutex; // mutable para uso em métodos const
         const size_t maxSize;
 
+        // Último segundo formatado: mensagens no mesmo segundo reaproveitam o texto
+        time_t lastStampSecond = -1;
+        char lastStamp[8] = {};
+
+        // Log durável opcional: cada mensagem nova também vai para o disco
+        std::shared_ptr<HistoryStore> store;
+
+        // Índice invertido da janela atual: entra no add, sai no descarte
+        SearchIndex index;
+        std::vector<uint64_t> recoveredKeys; // chaves de cada registro no attachStore
+
+        // Bloco de boas-vindas/histórico pronto para envio; refeito só após mudanças
+        mutable SharedBuffer recentBlock;
+        mutable size_t recentBlockCount = 0;
+
+        const char* formatTimestamp(std::chrono::system_clock::time_point timestamp);
+        SharedBuffer render(const HistoryEntry& entry);
+        std::vector<std::string> renderedRange(size_t count) const;
+        std::vector<HistoryLine> linesFrom(size_t start) const;
+        void push(HistoryEntry entry, const std::vector<uint64_t>& keys);
+
 public:
         explicit MessageHistory(size_t max = 100);
 
         // Adiciona mensagem ao histórico
         void addMessage(const std::string& msg, int senderSocket);
 
+        // Adiciona a linha já codificada para o broadcast, sem copiar.
+        // Retorna a sequência atribuída (a ordem do histórico é a ordem das sequências)
+        uint64_t addMessage(SharedBuffer framed, int senderSocket);
+
+        // Liga o log durável: recarrega dele as últimas mensagens (até o limite
+        // do histórico) e passa a gravar as novas. Retorna quantas foram recarregadas
+        size_t attachStore(std::shared_ptr<HistoryStore> durable);
+
         // Retorna últimas N mensagens
         std::vector<std::string> getRecentMessages(size_t count = 10) const;
 
-        // Retorna todas as mensagens
+        // Últimas N mensagens com as sequências
+        std::vector<HistoryLine> getRecentLines(size_t count = 10) const;
+
+        // Mensagens com sequência maior que 'after', localizadas por índice no anel
+        HistorySlice since(uint64_t after) const;
+
+        // Até 'limit' mensagens mais recentes com todos os termos de 'query'
+        // no texto da mensagem (sem o prefixo "Cliente N: "; sem diferenciar
+        // maiúsculas ASCII), em ordem cronológica, pelo índice
+        // invertido. Retorna false se a consulta não tem nenhum termo
+        bool search(std::string_view query, size_t limit, std::vector<HistoryLine>& lines) const;
+
+        // Última sequência atribuída (0 se nenhuma)
+        uint64_t lastSequence() const;
+
+        // Retorna todas as mensagens (cópias das linhas já renderizadas)
         std::vector<std::string> getAllMessages() const;
 
+        // Bloco enviado na entrada do cliente (boas-vindas ou últimas N mensagens).
+        // Fica em cache até a próxima alteração: entradas seguidas custam um envio compartilhado
+        SharedBuffer getRecentBlock(size_t count = 10) const;
+
         // Retorna total de mensagens no histórico
         size_t size() const;
 
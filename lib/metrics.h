@@ -0,0 +1,108 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Contador sem travas, dividido em faixas por thread para não disputar a
+// mesma linha de cache entre shards; a leitura soma as faixas
+class Counter {
+public:
+        void add(uint64_t amount = 1) {
+                stripes[stripeIndex()].value.fetch_add(amount, std::memory_order_relaxed);
+        }
+
+        uint64_t value() const;
+
+private:
+        static constexpr size_t STRIPES = 16;
+
+        struct alignas(64) Stripe {
+                std::atomic<uint64_t> value{0};
+        };
+
+        static size_t stripeIndex();
+
+        std::array<Stripe, STRIPES> stripes;
+};
+
+// Valor instantâneo (ex: profundidade de fila)
+class Gauge {
+public:
+        void set(int64_t v) { current.store(v, std::memory_order_relaxed); }
+        void add(int64_t delta) { current.fetch_add(delta, std::memory_order_relaxed); }
+        int64_t value() const { return current.load(std::memory_order_relaxed); }
+
+private:
+        std::atomic<int64_t> current{0};
+};
+
+// Histograma log-linear no estilo HDR: cada potência de 2 é dividida em
+// SUB_BUCKETS faixas, com erro relativo de até 1/SUB_BUCKETS (~6%).
+// record() faz dois fetch_add relaxados (faixa e soma) e, só quando o valor
+// passa do máximo atual, um laço de compare_exchange; nenhuma trava
+class LatencyHistogram {
+public:
+        void record(uint64_t value);
+
+        uint64_t count() const;
+        uint64_t sum() const { return total.load(std::memory_order_relaxed); }
+        uint64_t max() const { return maximum.load(std::memory_order_relaxed); }
+
+        // Limite superior do bucket que contém o percentil (0.0 a 1.0)
+        uint64_t percentile(double p) const;
+
+private:
+        static constexpr unsigned SUB_BITS = 4;
+        static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BITS;
+        static constexpr size_t BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+        static size_t bucketIndex(uint64_t value);
+        static uint64_t bucketUpperBound(size_t index);
+
+        std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+        std::atomic<uint64_t> total{0};
+        std::atomic<uint64_t> maximum{0};
+};
+
+// Registro de métricas nomeadas. O registro acontece na inicialização;
+// depois disso o caminho quente só toca os atomics de cada métrica
+class MetricsRegistry {
+public:
+        enum class Kind { Counter, Gauge, Histogram };
+
+        Counter& counter(const std::string& name, const std::string& help);
+        Gauge& gauge(const std::string& name, const std::string& help);
+        LatencyHistogram& histogram(const std::string& name, const std::string& help);
+
+        // Métrica calculada na leitura (ex: clientes conectados, contadores já existentes)
+        void function(const std::string& name, const std::string& help, Kind kind, std::function<int64_t()> read);
+
+        // Formato texto do Prometheus (exposition format 0.0.4)
+        std::string renderText() const;
+
+private:
+        struct Entry {
+                std::string name;
+                std::string help;
+                Kind kind;
+                std::unique_ptr<Counter> counter;
+                std::unique_ptr<Gauge> gauge;
+                std::unique_ptr<LatencyHistogram> histogram;
+                std::function<int64_t()> read;
+        };
+
+        Entry& addEntry(const std::string& name, const std::string& help, Kind kind);
+
+        mutable std::mutex registryMutex;
+        std::deque<Entry> entries;
+};
+
+#endif // METRICS_H
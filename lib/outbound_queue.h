@@ -0,0 +1,58 @@
+#ifndef OUTBOUND_QUEUE_H
+#define OUTBOUND_QUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include "ring_buffer.h"
+#include "shared_buffer.h"
+
+// O que fazer quando um cliente lento enche a fila de saída
+enum class SlowConsumerPolicy {
+        DropOldest, // descarta a mensagem mais antiga ainda não iniciada
+        DropNew,    // descarta a mensagem que está chegando
+        Disconnect  // desconecta o cliente
+};
+
+// Contadores globais de cada política (atualizados pelo servidor)
+struct BackpressureStats {
+        std::atomic<uint64_t> droppedOldest{0};
+        std::atomic<uint64_t> droppedNew{0};
+        std::atomic<uint64_t> disconnected{0};
+};
+
+// Fila de saída limitada de um cliente, drenada com sendmsg() não bloqueante.
+// Guarda apenas referências para buffers compartilhados: enfileirar não copia bytes.
+class OutboundQueue {
+public:
+        enum class PushResult { Queued, DroppedOldest, DroppedNew, Overflow };
+        enum class FlushResult { Drained, WouldBlock, Error };
+
+        OutboundQueue(size_t maxMessages, SlowConsumerPolicy policy);
+
+        // Enfileira aplicando a política quando a fila está cheia.
+        // Overflow significa que a política é Disconnect e nada foi enfileirado.
+        PushResult push(SharedBuffer data);
+
+        // Envia o máximo possível sem bloquear, agrupando várias mensagens
+        // por chamada (scatter-gather); envios parciais continuam de onde pararam.
+        // cork: quando o lote exige mais de um sendmsg(), segura os segmentos
+        // parciais com TCP_CORK até o fim da descarga
+        FlushResult flush(int fd, bool cork = false);
+
+        bool empty() const;
+        size_t size() const;
+
+        // Bytes ainda não enviados (base do limite do lote de envio)
+        size_t bytesPending() const;
+
+private:
+        mutable std::mutex queueMutex;
+        RingBuffer<SharedBuffer> pending;
+        size_t headOffset = 0; // bytes já enviados da primeira mensagem
+        size_t queuedBytes = 0; // soma dos tamanhos em 'pending'
+        const size_t maxMessages;
+        const SlowConsumerPolicy policy;
+};
+
+#endif // OUTBOUND_QUEUE_H
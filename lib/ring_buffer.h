@@ -0,0 +1,93 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Fila circular sobre um vector com capacidade em potência de dois.
+// Cresce sob demanda e nunca encolhe: depois de atingir o pico, push/pop
+// só reaproveitam slots (ao contrário do std::deque, que aloca e libera
+// blocos conforme a fila anda).
+template <typename T>
+class RingBuffer {
+public:
+        bool empty() const {
+                return count == 0;
+        }
+
+        size_t size() const {
+                return count;
+        }
+
+        T& operator[](size_t i) {
+                return slots[(head + i) & (slots.size() - 1)];
+        }
+
+        const T& operator[](size_t i) const {
+                return slots[(head + i) & (slots.size() - 1)];
+        }
+
+        T& front() {
+                return slots[head];
+        }
+
+        const T& front() const {
+                return slots[head];
+        }
+
+        void push_back(T value) {
+                if (count == slots.size()) {
+                        grow();
+                }
+                (*this)[count] = std::move(value);
+                count++;
+        }
+
+        // O slot liberado volta a T(): referências (ex.: SharedBuffer) caem na hora
+        void pop_front() {
+                slots[head] = T();
+                head = (head + 1) & (slots.size() - 1);
+                count--;
+        }
+
+        // Remove o elemento i preservando a ordem dos demais. Desloca o lado mais
+        // curto: perto da frente (descarte do mais antigo) custa O(i), não O(size)
+        void erase(size_t i) {
+                if (i < count / 2) {
+                        for (; i > 0; --i) {
+                                (*this)[i] = std::move((*this)[i - 1]);
+                        }
+                        pop_front();
+                        return;
+                }
+                for (; i + 1 < count; ++i) {
+                        (*this)[i] = std::move((*this)[i + 1]);
+                }
+                (*this)[count - 1] = T();
+                count--;
+        }
+
+        void clear() {
+                while (count > 0) {
+                        pop_front();
+                }
+                head = 0;
+        }
+
+private:
+        void grow() {
+                std::vector<T> larger(slots.empty() ? 8 : slots.size() * 2);
+                for (size_t i = 0; i < count; ++i) {
+                        larger[i] = std::move((*this)[i]);
+                }
+                slots = std::move(larger);
+                head = 0;
+        }
+
+        std::vector<T> slots;
+        size_t head = 0;
+        size_t count = 0;
+};
+
+#endif // RING_BUFFER_H
@@ -0,0 +1,59 @@
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ring_buffer.h"
+
+// Índice invertido do histórico: token -> sequências (crescentes) das
+// mensagens que o contêm. Atualizado a cada mensagem nova e a cada
+// remoção, a busca só percorre as listas dos termos pedidos.
+// Não é thread-safe: o MessageHistory o protege com o próprio mutex.
+class SearchIndex {
+public:
+        // Tokens são sequências de letras, dígitos ou bytes UTF-8 (>= 0x80),
+        // com ASCII em minúsculas; só os primeiros MAX_TOKEN_BYTES contam
+        static constexpr size_t MAX_TOKEN_BYTES = 64;
+
+        // Chaves (hash de 64 bits de cada token) sem repetição, em 'keys'.
+        // Não mexe no índice: pode rodar fora da trava de quem o protege
+        static void tokenize(std::string_view text, std::vector<uint64_t>& keys);
+
+        // Indexa a mensagem 'sequence' com as chaves de tokenize();
+        // as sequências devem chegar em ordem crescente
+        void add(uint64_t sequence, const std::vector<uint64_t>& keys);
+
+        // Remove a mensagem mais antiga ainda indexada (o mesmo texto passado ao add)
+        void remove(uint64_t sequence, std::string_view text);
+
+        // Até 'limit' sequências que contêm todos os termos de 'query', da mais
+        // nova para a mais antiga. Retorna false se a consulta não tem tokens
+        bool search(std::string_view query, size_t limit, std::vector<uint64_t>& matches) const;
+
+        void clear();
+
+        // Tokens distintos e total de ocorrências indexadas
+        size_t tokenCount() const {
+                return postings.size();
+        }
+        size_t postingCount() const {
+                return totalPostings;
+        }
+
+private:
+        using Postings = RingBuffer<uint64_t>;
+
+        // Chave: hash de 64 bits do token normalizado; evita guardar e
+        // alocar strings por token, e colisões nessa largura são desprezíveis
+        std::unordered_map<uint64_t, Postings> postings;
+        size_t totalPostings = 0;
+        // Nós de listas que esvaziaram, com o anel ainda alocado: um token novo
+        // reaproveita um deles em vez de alocar nó e vetor
+        std::vector<std::unordered_map<uint64_t, Postings>::node_type> spareNodes;
+        std::vector<uint64_t> scratch; // reaproveitado por remove
+};
+
+#endif // SEARCH_INDEX_H
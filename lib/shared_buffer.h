@@ -0,0 +1,128 @@
+#ifndef SHARED_BUFFER_H
+#define SHARED_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include "memory_pool.h"
+
+// Mensagem já com framing, imutável após criada.
+// Codificada uma única vez e compartilhada (contagem de referência) por
+// todas as filas de saída, pelo histórico e pelas inboxes dos shards.
+// Cabeçalho e bytes ficam num único bloco do BufferPool: criar e liberar
+// uma mensagem em regime estável não passa pelo heap.
+class MessageBuffer {
+private:
+        friend class SharedBuffer;
+
+        mutable std::atomic<uint32_t> refs{1};
+        uint32_t length;
+        size_t blockSize; // tamanho pedido ao pool, devolvido na liberação
+
+        MessageBuffer(uint32_t length, size_t blockSize) : length(length), blockSize(blockSize) {
+        }
+
+        char* bytes() {
+                return reinterpret_cast<char*>(this + 1);
+        }
+
+public:
+        // Delete copy
+        MessageBuffer(const MessageBuffer&) = delete;
+        MessageBuffer& operator=(const MessageBuffer&) = delete;
+
+        const char* data() const {
+                return reinterpret_cast<const char*>(this + 1);
+        }
+
+        size_t size() const {
+                return length;
+        }
+
+        std::string_view view() const {
+                return std::string_view(data(), length);
+        }
+};
+
+// Ponteiro com contagem intrusiva para um MessageBuffer (nulo por padrão)
+class SharedBuffer {
+public:
+        SharedBuffer() noexcept = default;
+
+        SharedBuffer(std::nullptr_t) noexcept {
+        }
+
+        SharedBuffer(const SharedBuffer& other) noexcept : buffer(other.buffer) {
+                if (buffer) {
+                        buffer->refs.fetch_add(1, std::memory_order_relaxed);
+                }
+        }
+
+        SharedBuffer(SharedBuffer&& other) noexcept : buffer(std::exchange(other.buffer, nullptr)) {
+        }
+
+        SharedBuffer& operator=(SharedBuffer other) noexcept {
+                std::swap(buffer, other.buffer);
+                return *this;
+        }
+
+        ~SharedBuffer() {
+                release();
+        }
+
+        void reset() noexcept {
+                release();
+                buffer = nullptr;
+        }
+
+        const MessageBuffer* get() const noexcept {
+                return buffer;
+        }
+
+        const MessageBuffer* operator->() const noexcept {
+                return buffer;
+        }
+
+        const MessageBuffer& operator*() const noexcept {
+                return *buffer;
+        }
+
+        explicit operator bool() const noexcept {
+                return buffer != nullptr;
+        }
+
+        // Reserva 'size' bytes e chama fill(char*) para escrevê-los direto no bloco final
+        template <typename Fill>
+        static SharedBuffer build(size_t size, Fill&& fill) {
+                size_t blockSize = sizeof(MessageBuffer) + size;
+                void* block = BufferPool::instance().allocate(blockSize);
+                MessageBuffer* created = new (block) MessageBuffer(static_cast<uint32_t>(size), blockSize);
+                fill(created->bytes());
+                return SharedBuffer(created);
+        }
+
+private:
+        explicit SharedBuffer(MessageBuffer* created) noexcept : buffer(created) {
+        }
+
+        void release() noexcept {
+                if (buffer && buffer->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        size_t blockSize = buffer->blockSize;
+                        buffer->~MessageBuffer();
+                        BufferPool::instance().release(const_cast<MessageBuffer*>(buffer), blockSize);
+                }
+        }
+
+        const MessageBuffer* buffer = nullptr;
+};
+
+static_assert(sizeof(MessageBuffer) == 16, "cabeçalho mantém os bytes alinhados");
+
+inline SharedBuffer makeSharedBuffer(std::string_view bytes) {
+        return SharedBuffer::build(bytes.size(), [&](char* out) { std::memcpy(out, bytes.data(), bytes.size()); });
+}
+
+#endif // SHARED_BUFFER_H
@@ -0,0 +1,87 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Roda de temporizadores hierárquica: LEVELS níveis de SLOTS posições, cada
+// nível com ticks SLOTS vezes maiores que o anterior. Inserir e cancelar são
+// O(1) (listas duplamente ligadas por índice); um temporizador distante desce
+// de nível (cascata) só quando a roda de baixo dá a volta até ele.
+// Um mapa de bits por nível diz quais posições estão ocupadas, então o tempo
+// até o próximo disparo sai sem varrer a roda e o laço só acorda quando há o que fazer.
+// Não é thread-safe: pertence à thread do EventLoop que a avança.
+class TimerWheel {
+public:
+        using Callback = std::function<void()>;
+        using Clock = std::chrono::steady_clock;
+        // Índice do nó + geração (um id cancelado ou já disparado nunca volta a valer); 0 = nenhum
+        using TimerId = uint64_t;
+
+        static constexpr size_t SLOTS = 64;
+        static constexpr size_t LEVELS = 4; // 64^4 ticks: ~46 h com ticks de 10 ms
+
+        explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(10));
+
+        // Delete copy
+        TimerWheel(const TimerWheel&) = delete;
+        TimerWheel& operator=(const TimerWheel&) = delete;
+
+        // Agenda 'callback' para 'delay' depois de 'now' (arredondado para cima, no mínimo um tick)
+        TimerId schedule(std::chrono::milliseconds delay, Callback callback, Clock::time_point now = Clock::now());
+
+        // Remove um temporizador pendente; false se ele já disparou ou foi cancelado
+        bool cancel(TimerId id);
+
+        // Dispara, em ordem de vencimento, tudo o que venceu até 'now'. Callbacks
+        // podem agendar e cancelar livremente. Retorna quantos dispararam
+        size_t advance(Clock::time_point now);
+
+        // Milissegundos até o próximo tick que dispara ou desce um temporizador
+        // (-1 se a roda está vazia): o limite de espera do epoll_wait
+        int timeoutMs(Clock::time_point now) const;
+
+        // Temporizadores pendentes
+        size_t size() const {
+                return active;
+        }
+
+private:
+        static constexpr uint32_t NIL = UINT32_MAX;
+        static constexpr uint32_t DUE = UINT32_MAX - 1; // fora das listas, no lote sendo disparado
+        static constexpr unsigned SLOT_BITS = 6;         // log2(SLOTS)
+
+        struct Node {
+                Callback callback;
+                uint64_t expiry = 0; // tick absoluto
+                uint32_t generation = 1;
+                uint32_t bucket = NIL; // nível * SLOTS + posição; NIL = livre
+                uint32_t prev = NIL;
+                uint32_t next = NIL;
+        };
+
+        uint64_t tickOf(Clock::time_point time) const;
+        void insert(uint32_t index);
+        void unlink(uint32_t index);
+        void release(uint32_t index);
+        // Ticks de 'current' até o próximo evento (UINT64_MAX se vazia)
+        uint64_t ticksToNext() const;
+        void cascade(size_t level);
+
+        const Clock::duration tick;
+        const Clock::time_point origin;
+        uint64_t current = 0; // último tick processado
+
+        std::vector<Node> nodes;
+        std::vector<uint32_t> freeNodes;
+        std::array<uint32_t, LEVELS * SLOTS> heads;
+        std::array<uint64_t, LEVELS> occupied{}; // bit s = posição s do nível com temporizadores
+        std::vector<uint32_t> due;                // reaproveitado a cada tick
+        size_t active = 0;
+};
+
+#endif // TIMER_WHEEL_H
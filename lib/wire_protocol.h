@@ -0,0 +1,53 @@
+#ifndef WIRE_PROTOCOL_H
+#define WIRE_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "shared_buffer.h"
+
+// Protocolo binário opcional, negociado na conexão.
+//
+// O cliente binário envia BINARY_HELLO logo após conectar. Ele começa com
+// '\0', byte que nunca aparece no protocolo de texto, então o servidor decide
+// o protocolo pelo primeiro byte recebido. O servidor responde com o mesmo
+// preâmbulo e daí em diante só envia quadros; o que chegar antes dele (texto de
+// boas-vindas) deve ser descartado pelo cliente.
+//
+// Quadro: cabeçalho fixo de 20 bytes em ordem de rede, seguido do payload.
+//   u32 length | u8 type | u8 flags | u16 reservado | u64 sequence | u32 senderId
+constexpr char BINARY_HELLO[] = {'\0', 'C', 'H', 'B'};
+constexpr size_t BINARY_HELLO_SIZE = sizeof(BINARY_HELLO);
+
+constexpr size_t FRAME_HEADER_SIZE = 20;
+constexpr uint32_t MAX_FRAME_PAYLOAD = 1 << 20;
+
+enum class FrameType : uint8_t {
+        Chat = 1,    // mensagem de chat (payload = texto cru, sem prefixo nem CR/LF)
+        History = 2, // linha do histórico já formatada
+        System = 3,  // aviso do servidor
+        Gap = 4,     // retomada: mensagens perdidas já saíram do histórico;
+                     // sequence = primeira ainda disponível, payload = aviso
+        Direct = 5,  // mensagem privada (/msg): payload = texto cru, senderId = remetente
+        Ping = 6     // heartbeat do servidor; o cliente responde com outro Ping (payload vazio)
+};
+
+struct FrameHeader {
+        uint32_t length = 0;
+        FrameType type = FrameType::Chat;
+        uint8_t flags = 0;
+        uint64_t sequence = 0;
+        uint32_t senderId = 0;
+};
+
+// Codifica cabeçalho + payload em um buffer compartilhável
+SharedBuffer encodeFrame(FrameType type, uint64_t sequence, uint32_t senderId, std::string_view payload);
+
+// Resultado da decodificação do início de um fluxo de bytes
+enum class DecodeStatus { Complete, Incomplete, Invalid };
+
+// Em Complete, consumed recebe o tamanho total do quadro e payload aponta para dentro de data
+DecodeStatus decodeFrame(std::string_view data, FrameHeader& header, std::string_view& payload, size_t& consumed);
+
+#endif // WIRE_PROTOCOL_H
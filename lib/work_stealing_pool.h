@@ -0,0 +1,105 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool fixo de workers com roubo de tarefas.
+// Cada worker tem a própria fila: consome do início (ordem de chegada) e,
+// quando ela esvazia, rouba do fim da fila de outro worker. Tarefas criadas
+// dentro de um worker vão para a fila dele; as externas são distribuídas em rodízio.
+class WorkStealingPool {
+public:
+        using Task = std::function<void()>;
+
+        // workers = 0: um por núcleo
+        explicit WorkStealingPool(size_t workers = 0);
+        ~WorkStealingPool();
+
+        // Delete copy
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+        void submit(Task task);
+
+        // Para os workers e aguarda o término; tarefas ainda na fila são descartadas
+        void shutdown();
+
+        size_t workerCount() const {
+                return workers.size();
+        }
+
+        // Tarefas aguardando execução em todas as filas
+        size_t queueDepth() const {
+                return pending.load(std::memory_order_relaxed);
+        }
+
+        // Tarefas na fila de um worker específico
+        size_t workerDepth(size_t index) const;
+
+        uint64_t executedCount() const {
+                return executed.load(std::memory_order_relaxed);
+        }
+
+        uint64_t stealCount() const {
+                return steals.load(std::memory_order_relaxed);
+        }
+
+private:
+        struct alignas(64) Worker {
+                mutable std::mutex mutex;
+                std::deque<Task> tasks;
+        };
+
+        void run(size_t index);
+        bool popLocal(size_t index, Task& task);
+        bool steal(size_t thief, Task& task);
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::vector<std::thread> threads;
+
+        std::atomic<size_t> pending{0};
+        std::atomic<size_t> nextWorker{0};
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> steals{0};
+
+        // Workers sem trabalho dormem aqui; 'sleeping' evita notify sem ninguém esperando
+        std::mutex sleepMutex;
+        std::condition_variable wakeup;
+        std::atomic<size_t> sleeping{0};
+        std::atomic<bool> stopping{false};
+};
+
+// Executa tarefas em ordem, uma por vez, sobre o pool: tarefas do mesmo
+// strand nunca rodam em paralelo, mas strands diferentes se espalham pelos workers.
+// Sempre criado por shared_ptr (as tarefas em execução mantêm o strand vivo).
+class Strand : public std::enable_shared_from_this<Strand> {
+public:
+        using Task = WorkStealingPool::Task;
+
+        explicit Strand(WorkStealingPool& pool) : pool(pool) {
+        }
+
+        void post(Task task);
+
+private:
+        // Tarefas executadas por vez antes de devolver o worker ao pool
+        static constexpr size_t MAX_TASKS_PER_RUN = 16;
+
+        void drain();
+
+        WorkStealingPool& pool;
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        bool scheduled = false;
+};
+
+#endif // WORK_STEALING_POOL_H
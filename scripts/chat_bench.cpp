@@ -0,0 +1,406 @@
+// Benchmark de carga e latência de fan-out do servidor de chat.
+// Conecta N clientes, envia mensagens com timestamp embutido e mede o tempo
+// até cada destinatário receber a cópia. Resultado em JSON.
+#include "../lib/line_framer.h"
+#include "../lib/metrics.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Janela de contagem de recebimentos por remetente (modo fechado)
+constexpr size_t SEQ_RING = 4096;
+
+struct BenchConfig {
+        std::string host = "127.0.0.1";
+        int port = 8080;
+        int clients = 50;
+        int senders = 0;         // 0 = todos os clientes enviam
+        double rate = 1000;      // mensagens/s somando todos os remetentes (modo aberto)
+        size_t size = 64;        // bytes de payload por mensagem
+        double duration = 10;    // segundos medidos
+        double warmup = 1;       // segundos descartados no início
+        bool closedLoop = false; // fechado: cada remetente espera suas mensagens chegarem
+        int window = 1;          // mensagens em voo por remetente no modo fechado
+        int receiverThreads = 4;
+        std::string jsonPath;    // vazio = stdout
+};
+
+struct Sender {
+        int socket = -1;
+        std::atomic<uint64_t> completed{0}; // mensagens recebidas por todos os destinatários
+        std::unique_ptr<std::atomic<uint32_t>[]> copies{new std::atomic<uint32_t>[SEQ_RING]()};
+};
+
+struct Connection {
+        int socket = -1;
+        LineFramer framer;
+};
+
+struct BenchState {
+        BenchConfig config;
+        std::vector<std::unique_ptr<Connection>> connections;
+        std::vector<std::unique_ptr<Sender>> senders;
+        LatencyHistogram latency;
+        std::atomic<uint64_t> sent{0};
+        std::atomic<uint64_t> measuredSent{0};
+        std::atomic<uint64_t> received{0};
+        std::atomic<uint64_t> measuredReceived{0};
+        std::atomic<bool> sending{true};
+        std::atomic<bool> receiving{true};
+        Clock::time_point epoch = Clock::now();
+        int64_t measureStartNs = 0;
+        int64_t measureEndNs = 0;
+};
+
+int64_t nowNs(const BenchState& state) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - state.epoch).count();
+}
+
+int connectTo(const BenchConfig& config) {
+        int sock = socket(AF_INET, SOCK_STREAM, 0);
+        if (sock < 0) {
+                return -1;
+        }
+
+        sockaddr_in serverAddr{};
+        serverAddr.sin_family = AF_INET;
+        serverAddr.sin_port = htons(config.port);
+        inet_pton(AF_INET, config.host.c_str(), &serverAddr.sin_addr);
+
+        if (connect(sock, (sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+                close(sock);
+                return -1;
+        }
+
+        int one = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        return sock;
+}
+
+// Payload: "B <remetente> <seq> <ns>" completado com 'x' até o tamanho pedido
+std::string buildPayload(size_t sender, uint64_t seq, int64_t sendNs, size_t size) {
+        char header[64];
+        int n = snprintf(header, sizeof(header), "B %zu %llu %lld ", sender,
+                         static_cast<unsigned long long>(seq), static_cast<long long>(sendNs));
+        std::string line(header, static_cast<size_t>(n));
+        if (line.size() < size) {
+                line.append(size - line.size(), 'x');
+        }
+        line += '\n';
+        return line;
+}
+
+bool sendAll(int sock, const std::string& data) {
+        size_t offset = 0;
+        while (offset < data.size()) {
+                ssize_t n = send(sock, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR) {
+                        continue;
+                }
+                if (n <= 0) {
+                        return false;
+                }
+                offset += static_cast<size_t>(n);
+        }
+        return true;
+}
+
+// Linha recebida: "Cliente N: B <remetente> <seq> <ns> xxx"
+void onLine(BenchState& state, std::string_view line) {
+        size_t marker = line.find(": B ");
+        if (marker == std::string_view::npos) {
+                return; // histórico, boas-vindas ou outras mensagens
+        }
+
+        unsigned long long sender = 0;
+        unsigned long long seq = 0;
+        long long sendNs = 0;
+        std::string fields(line.substr(marker + 4, 64));
+        if (sscanf(fields.c_str(), "%llu %llu %lld", &sender, &seq, &sendNs) != 3 || sender >= state.senders.size()) {
+                return;
+        }
+
+        int64_t now = nowNs(state);
+        state.received++;
+        if (sendNs >= state.measureStartNs && sendNs < state.measureEndNs) {
+                state.measuredReceived++;
+                state.latency.record(static_cast<uint64_t>(now - sendNs));
+        }
+
+        // Todos os clientes, menos o remetente, recebem cada mensagem
+        Sender& origin = *state.senders[sender];
+        uint32_t expected = static_cast<uint32_t>(state.connections.size() - 1);
+        if (origin.copies[seq % SEQ_RING].fetch_add(1) + 1 == expected) {
+                origin.copies[seq % SEQ_RING] = 0;
+                origin.completed++;
+        }
+}
+
+void receiverLoop(BenchState& state, size_t first, size_t step) {
+        int epollFd = epoll_create1(EPOLL_CLOEXEC);
+        for (size_t i = first; i < state.connections.size(); i += step) {
+                epoll_event ev{};
+                ev.events = EPOLLIN;
+                ev.data.u64 = i;
+                epoll_ctl(epollFd, EPOLL_CTL_ADD, state.connections[i]->socket, &ev);
+        }
+
+        epoll_event events[64];
+        while (state.receiving) {
+                int ready = epoll_wait(epollFd, events, 64, 100);
+                for (int e = 0; e < ready; ++e) {
+                        Connection& conn = *state.connections[events[e].data.u64];
+                        char* space = conn.framer.prepareWrite(16 * 1024);
+                        ssize_t n = recv(conn.socket, space, 16 * 1024, MSG_DONTWAIT);
+                        if (n <= 0) {
+                                continue;
+                        }
+                        conn.framer.commitWrite(static_cast<size_t>(n));
+
+                        std::string_view line;
+                        while (conn.framer.nextLine(line)) {
+                                onLine(state, line);
+                        }
+                }
+        }
+
+        close(epollFd);
+}
+
+// Aberto: envia no horário agendado, independente das respostas, e usa o
+// horário agendado como timestamp (evita omissão coordenada).
+// Fechado: cada remetente mantém no máximo 'window' mensagens em voo.
+void senderLoop(BenchState& state, size_t first, size_t step, double threadRate) {
+        const BenchConfig& config = state.config;
+        std::vector<uint64_t> nextSeq(state.senders.size(), 0);
+        int64_t interval = threadRate > 0 ? static_cast<int64_t>(1e9 / threadRate) : 0;
+        int64_t scheduled = nowNs(state);
+        size_t current = first;
+
+        while (state.sending) {
+                Sender& sender = *state.senders[current];
+                int64_t sendNs;
+
+                if (config.closedLoop) {
+                        if (nextSeq[current] - sender.completed.load() >= static_cast<uint64_t>(config.window)) {
+                                current = current + step < state.senders.size() ? current + step : first;
+                                std::this_thread::yield();
+                                continue;
+                        }
+                        sendNs = nowNs(state);
+                } else {
+                        int64_t now = nowNs(state);
+                        if (now < scheduled) {
+                                std::this_thread::sleep_for(std::chrono::nanoseconds(std::min<int64_t>(scheduled - now, 1000000)));
+                                continue;
+                        }
+                        sendNs = scheduled;
+                        scheduled += interval;
+                }
+
+                uint64_t seq = nextSeq[current]++;
+                if (!sendAll(sender.socket, buildPayload(current, seq, sendNs, config.size))) {
+                        break;
+                }
+                state.sent++;
+                if (sendNs >= state.measureStartNs && sendNs < state.measureEndNs) {
+                        state.measuredSent++;
+                }
+
+                current = current + step < state.senders.size() ? current + step : first;
+        }
+}
+
+BenchConfig parseArgs(int argc, char* argv[]) {
+        BenchConfig config;
+
+        for (int i = 1; i < argc; ++i) {
+                std::string arg = argv[i];
+                auto value = [&](const char* prefix) { return arg.substr(strlen(prefix)); };
+
+                if (arg.rfind("--host=", 0) == 0) {
+                        config.host = value("--host=");
+                } else if (arg.rfind("--port=", 0) == 0) {
+                        config.port = std::stoi(value("--port="));
+                } else if (arg.rfind("--clients=", 0) == 0) {
+                        config.clients = std::stoi(value("--clients="));
+                } else if (arg.rfind("--senders=", 0) == 0) {
+                        config.senders = std::stoi(value("--senders="));
+                } else if (arg.rfind("--rate=", 0) == 0) {
+                        config.rate = std::stod(value("--rate="));
+                } else if (arg.rfind("--size=", 0) == 0) {
+                        config.size = std::stoul(value("--size="));
+                } else if (arg.rfind("--duration=", 0) == 0) {
+                        config.duration = std::stod(value("--duration="));
+                } else if (arg.rfind("--warmup=", 0) == 0) {
+                        config.warmup = std::stod(value("--warmup="));
+                } else if (arg == "--mode=open") {
+                        config.closedLoop = false;
+                } else if (arg == "--mode=closed") {
+                        config.closedLoop = true;
+                } else if (arg.rfind("--window=", 0) == 0) {
+                        config.window = std::stoi(value("--window="));
+                } else if (arg.rfind("--receivers=", 0) == 0) {
+                        config.receiverThreads = std::stoi(value("--receivers="));
+                } else if (arg.rfind("--json=", 0) == 0) {
+                        config.jsonPath = value("--json=");
+                } else {
+                        throw std::invalid_argument("argumento desconhecido '" + arg +
+                                                    "' (uso: chat_bench [--host=IP] [--port=N] [--clients=N] [--senders=N]"
+                                                    " [--rate=MSG/S] [--size=BYTES] [--duration=S] [--warmup=S]"
+                                                    " [--mode=open|closed] [--window=N] [--receivers=N] [--json=ARQUIVO])");
+                }
+        }
+
+        if (config.clients < 2) {
+                throw std::invalid_argument("são necessários pelo menos 2 clientes");
+        }
+        if (config.senders <= 0 || config.senders > config.clients) {
+                config.senders = config.clients;
+        }
+        config.window = std::max(1, std::min<int>(config.window, SEQ_RING / 2));
+        config.receiverThreads = std::max(1, config.receiverThreads);
+        return config;
+}
+
+std::string toJson(const BenchState& state, double elapsed) {
+        const BenchConfig& c = state.config;
+        const LatencyHistogram& h = state.latency;
+        uint64_t measured = state.measuredSent.load();
+        uint64_t expected = measured * static_cast<uint64_t>(c.clients - 1);
+        uint64_t samples = h.count();
+        auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+
+        std::ostringstream out;
+        out.setf(std::ios::fixed);
+        out.precision(3);
+        out << "{\n"
+            << "  \"tool\": \"chat_bench\",\n"
+            << "  \"config\": {\"host\": \"" << c.host << "\", \"port\": " << c.port
+            << ", \"clients\": " << c.clients << ", \"senders\": " << c.senders
+            << ", \"mode\": \"" << (c.closedLoop ? "closed" : "open") << "\""
+            << ", \"rate\": " << c.rate << ", \"window\": " << c.window
+            << ", \"size\": " << c.size << ", \"duration_s\": " << c.duration
+            << ", \"warmup_s\": " << c.warmup << "},\n"
+            << "  \"results\": {\n"
+            << "    \"elapsed_s\": " << elapsed << ",\n"
+            << "    \"messages_sent\": " << measured << ",\n"
+            << "    \"deliveries\": " << state.measuredReceived.load() << ",\n"
+            << "    \"expected_deliveries\": " << expected << ",\n"
+            << "    \"send_rate\": " << static_cast<double>(measured) / c.duration << ",\n"
+            << "    \"delivery_rate\": " << static_cast<double>(state.measuredReceived.load()) / c.duration << ",\n"
+            << "    \"latency_us\": {\"p50\": " << us(h.percentile(0.5)) << ", \"p90\": " << us(h.percentile(0.9))
+            << ", \"p99\": " << us(h.percentile(0.99)) << ", \"p999\": " << us(h.percentile(0.999))
+            << ", \"max\": " << us(h.max()) << ", \"mean\": " << (samples ? us(h.sum() / samples) : 0.0) << "}\n"
+            << "  }\n"
+            << "}\n";
+        return out.str();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+        BenchState state;
+        try {
+                state.config = parseArgs(argc, argv);
+        } catch (const std::exception& e) {
+                std::cerr << "Erro: " << e.what() << std::endl;
+                return 1;
+        }
+        const BenchConfig& config = state.config;
+
+        std::cerr << "📈 Conectando " << config.clients << " clientes em " << config.host << ":" << config.port << std::endl;
+        for (int i = 0; i < config.clients; ++i) {
+                auto conn = std::make_unique<Connection>();
+                conn->socket = connectTo(config);
+                if (conn->socket < 0) {
+                        std::cerr << "❌ Falha ao conectar o cliente " << i << std::endl;
+                        return 1;
+                }
+                if (i < config.senders) {
+                        auto sender = std::make_unique<Sender>();
+                        sender->socket = conn->socket;
+                        state.senders.push_back(std::move(sender));
+                }
+                state.connections.push_back(std::move(conn));
+        }
+
+        // Janela medida: [aquecimento, aquecimento + duração)
+        state.epoch = Clock::now();
+        state.measureStartNs = static_cast<int64_t>(config.warmup * 1e9);
+        state.measureEndNs = state.measureStartNs + static_cast<int64_t>(config.duration * 1e9);
+
+        std::vector<std::thread> receivers;
+        for (int r = 0; r < config.receiverThreads; ++r) {
+                receivers.emplace_back(receiverLoop, std::ref(state), static_cast<size_t>(r),
+                                       static_cast<size_t>(config.receiverThreads));
+        }
+
+        size_t senderThreads = std::min<size_t>(state.senders.size(), std::max(1u, std::thread::hardware_concurrency() / 2));
+        std::vector<std::thread> senders;
+        for (size_t t = 0; t < senderThreads; ++t) {
+                senders.emplace_back(senderLoop, std::ref(state), t, senderThreads, config.rate / static_cast<double>(senderThreads));
+        }
+
+        std::cerr << "⏱️  " << (config.closedLoop ? "Modo fechado" : "Modo aberto") << ": " << config.warmup
+                  << "s de aquecimento + " << config.duration << "s medidos" << std::endl;
+        std::this_thread::sleep_for(std::chrono::nanoseconds(state.measureEndNs));
+        state.sending = false;
+        for (auto& t : senders) {
+                t.join();
+        }
+
+        // Aguarda as cópias em trânsito (até 2s sem progresso)
+        uint64_t last = state.received;
+        for (int idle = 0; idle < 20; ++idle) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                uint64_t now = state.received;
+                if (now != last) {
+                        idle = 0;
+                        last = now;
+                }
+                if (state.measuredReceived >= state.measuredSent * static_cast<uint64_t>(config.clients - 1)) {
+                        break;
+                }
+        }
+        double elapsed = static_cast<double>(nowNs(state)) / 1e9;
+
+        state.receiving = false;
+        for (auto& t : receivers) {
+                t.join();
+        }
+        for (auto& conn : state.connections) {
+                close(conn->socket);
+        }
+
+        std::string json = toJson(state, elapsed);
+        if (config.jsonPath.empty()) {
+                std::cout << json;
+        } else {
+                std::ofstream(config.jsonPath) << json;
+                std::cerr << "📄 Resultado salvo em " << config.jsonPath << std::endl;
+                std::cerr << json;
+        }
+        return 0;
+}
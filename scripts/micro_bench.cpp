@@ -0,0 +1,413 @@
+// Microbenchmarks dos blocos do caminho quente: histórico, logger,
+// framing e codificação/fan-out do broadcast.
+// Sementes fixas; reporta ns/op, Mops/s e alocações por operação.
+// Uso: micro_bench [--filter=TEXTO] [--scale=F]
+#include "../lib/libtslog.h"
+#include "../lib/line_framer.h"
+#include "../lib/message_history.h"
+#include "../lib/outbound_queue.h"
+#include "../lib/shared_buffer.h"
+#include "../lib/wire_protocol.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Contagem global de alocações: operator new substituído só neste binário.
+// noinline: com malloc()/free() visíveis no chamador o g++ acusa par new/delete trocado
+static std::atomic<uint64_t> allocationCount{0};
+
+__attribute__((noinline)) void* operator new(std::size_t size) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        if (void* p = std::malloc(size ? size : 1)) {
+                return p;
+        }
+        throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+        std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept {
+        std::free(p);
+}
+
+namespace {
+
+constexpr uint32_t SEED = 20240611;
+
+struct Result {
+        std::string name;
+        int threads;
+        uint64_t ops;
+        double nsPerOp;     // custo por operação em cada thread
+        double mopsPerSec;  // vazão somada
+        double allocsPerOp;
+        std::string note;
+};
+
+std::string filter;
+double scale = 1.0;
+
+// Executa body(thread, ops) em 'threads' threads liberadas juntas
+Result runThreads(const std::string& name, int threads, uint64_t opsPerThread,
+                  const std::function<void(int, uint64_t)>& body) {
+        opsPerThread = std::max<uint64_t>(1, static_cast<uint64_t>(static_cast<double>(opsPerThread) * scale));
+
+        std::atomic<int> ready{0};
+        std::atomic<bool> go{false};
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+
+        for (int t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t] {
+                        ready++;
+                        while (!go.load(std::memory_order_acquire)) {
+                                std::this_thread::yield();
+                        }
+                        body(t, opsPerThread);
+                });
+        }
+        while (ready.load() < threads) {
+                std::this_thread::yield();
+        }
+
+        uint64_t allocsBefore = allocationCount.load();
+        auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& w : workers) {
+                w.join();
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        uint64_t allocs = allocationCount.load() - allocsBefore;
+
+        uint64_t totalOps = opsPerThread * static_cast<uint64_t>(threads);
+        Result result;
+        result.name = name;
+        result.threads = threads;
+        result.ops = totalOps;
+        result.nsPerOp = elapsed * threads / static_cast<double>(totalOps);
+        result.mopsPerSec = static_cast<double>(totalOps) / elapsed * 1e3;
+        result.allocsPerOp = static_cast<double>(allocs) / static_cast<double>(totalOps);
+        return result;
+}
+
+void report(const Result& r) {
+        std::printf("%-28s %4d %12llu %10.1f %10.2f %10.2f  %s\n", r.name.c_str(), r.threads,
+                    static_cast<unsigned long long>(r.ops), r.nsPerOp, r.mopsPerSec, r.allocsPerOp, r.note.c_str());
+        std::fflush(stdout);
+}
+
+// Reescala um resultado cuja iteração cobre 'perIteration' operações
+void normalize(Result& r, size_t perIteration) {
+        double n = static_cast<double>(perIteration);
+        r.ops *= perIteration;
+        r.nsPerOp /= n;
+        r.mopsPerSec *= n;
+        r.allocsPerOp /= n;
+}
+
+bool selected(const std::string& name) {
+        return filter.empty() || name.find(filter) != std::string::npos;
+}
+
+// Mensagens de tamanho variado, geradas com semente fixa
+std::vector<std::string> makeMessages(size_t count, size_t minSize, size_t maxSize) {
+        std::mt19937 rng(SEED);
+        std::uniform_int_distribution<size_t> sizeDist(minSize, maxSize);
+        std::uniform_int_distribution<int> charDist('a', 'z');
+
+        std::vector<std::string> messages(count);
+        for (auto& m : messages) {
+                m.resize(sizeDist(rng));
+                for (auto& c : m) {
+                        c = static_cast<char>(charDist(rng));
+                }
+        }
+        return messages;
+}
+
+// Mesmo formato de ChatMessage::text em tcp_server.cpp
+SharedBuffer encodeChatLine(int clientId, const std::string& message) {
+        static constexpr std::string_view PREFIX = "Cliente ";
+
+        char digits[16];
+        char* digitsEnd = std::to_chars(digits, digits + sizeof(digits), clientId).ptr;
+        size_t prefixSize = PREFIX.size() + (digitsEnd - digits) + 2;
+
+        return SharedBuffer::build(prefixSize + message.size() + 1, [&](char* out) {
+                out = std::copy(PREFIX.begin(), PREFIX.end(), out);
+                out = std::copy(digits, digitsEnd, out);
+                *out++ = ':';
+                *out++ = ' ';
+                out = std::copy(message.begin(), message.end(), out);
+                *out = '\n';
+        });
+}
+
+void benchHistory() {
+        const auto messages = makeMessages(256, 16, 200);
+        std::vector<SharedBuffer> lines;
+        for (size_t i = 0; i < messages.size(); ++i) {
+                lines.push_back(encodeChatLine(static_cast<int>(i), messages[i]));
+        }
+
+        for (int threads : {1, 2, 4, 8}) {
+                if (selected("history.add")) {
+                        MessageHistory history(100);
+                        report(runThreads("history.add", threads, 200000, [&](int t, uint64_t ops) {
+                                for (uint64_t i = 0; i < ops; ++i) {
+                                        history.addMessage(lines[(i + t) % lines.size()], t);
+                                }
+                        }));
+                }
+
+                if (selected("history.recent10")) {
+                        MessageHistory history(100);
+                        for (const auto& line : lines) {
+                                history.addMessage(line, 0);
+                        }
+                        report(runThreads("history.recent10", threads, 50000, [&](int, uint64_t ops) {
+                                for (uint64_t i = 0; i < ops; ++i) {
+                                        auto recent = history.getRecentMessages(10);
+                                }
+                        }));
+                }
+
+                if (selected("history.join_block")) {
+                        MessageHistory history(100);
+                        for (const auto& line : lines) {
+                                history.addMessage(line, 0);
+                        }
+                        report(runThreads("history.join_block", threads, 500000, [&](int, uint64_t ops) {
+                                for (uint64_t i = 0; i < ops; ++i) {
+                                        SharedBuffer block = history.getRecentBlock(10);
+                                }
+                        }));
+                }
+
+                // 90% escrita, 10% entradas (bloco de boas-vindas), sorteio com semente fixa
+                if (selected("history.mixed")) {
+                        MessageHistory history(100);
+                        report(runThreads("history.mixed", threads, 200000, [&](int t, uint64_t ops) {
+                                std::mt19937 rng(SEED + t);
+                                std::uniform_int_distribution<int> pick(0, 9);
+                                for (uint64_t i = 0; i < ops; ++i) {
+                                        if (pick(rng) == 0) {
+                                                SharedBuffer block = history.getRecentBlock(10);
+                                        } else {
+                                                history.addMessage(lines[(i + t) % lines.size()], t);
+                                        }
+                                }
+                        }));
+                }
+        }
+}
+
+// Janela de 100k mensagens com palavras de um vocabulário de 5000 (frequência
+// decrescente); consultas de 1 e 2 termos pelo índice invertido
+void benchSearch() {
+        if (!selected("history.search")) {
+                return;
+        }
+
+        std::mt19937 rng(SEED);
+        std::uniform_int_distribution<int> charDist('a', 'z');
+        std::vector<std::string> vocabulary(5000);
+        for (auto& word : vocabulary) {
+                word.resize(std::uniform_int_distribution<size_t>(3, 9)(rng));
+                for (auto& c : word) {
+                        c = static_cast<char>(charDist(rng));
+                }
+        }
+
+        // Índice ~ quadrado de um uniforme: palavras do começo aparecem bem mais
+        auto pickWord = [&](std::mt19937& r) -> const std::string& {
+                double u = std::uniform_real_distribution<double>(0.0, 1.0)(r);
+                return vocabulary[static_cast<size_t>(u * u * (vocabulary.size() - 1))];
+        };
+
+        constexpr size_t WINDOW = 100000;
+        MessageHistory history(WINDOW);
+        for (size_t i = 0; i < WINDOW + WINDOW / 10; ++i) {
+                std::string text;
+                for (int w = 0; w < 8; ++w) {
+                        text += pickWord(rng);
+                        text += ' ';
+                }
+                history.addMessage(encodeChatLine(static_cast<int>(i % 50), text), 0);
+        }
+
+        std::vector<std::string> queries;
+        for (int i = 0; i < 64; ++i) {
+                queries.push_back(i % 2 ? pickWord(rng) : pickWord(rng) + " " + pickWord(rng));
+        }
+
+        for (int threads : {1, 4}) {
+                report(runThreads("history.search", threads, 20000, [&](int t, uint64_t ops) {
+                        std::vector<HistoryLine> lines;
+                        for (uint64_t i = 0; i < ops; ++i) {
+                                history.search(queries[(i + t) % queries.size()], 20, lines);
+                        }
+                }));
+        }
+}
+
+void benchLogger() {
+        for (int threads : {1, 2, 4, 8, 16, 32, 64}) {
+                uint64_t opsPerThread = 400000 / threads;
+
+                if (selected("logger.log_string")) {
+                        ThreadSafeLogger logger;
+                        logger.initialize("/dev/null");
+                        const std::string message = "Mensagem recebida do Cliente 42: texto de exemplo";
+                        Result r = runThreads("logger.log_string", threads, opsPerThread, [&](int, uint64_t ops) {
+                                for (uint64_t i = 0; i < ops; ++i) {
+                                        logger.log(message);
+                                }
+                        });
+                        r.note = "descartadas " + std::to_string(logger.droppedCount());
+                        logger.shutdown();
+                        report(r);
+                }
+
+                if (selected("logger.event")) {
+                        ThreadSafeLogger logger;
+                        logger.initialize("/dev/null", LogOutput::Binary);
+                        Result r = runThreads("logger.event", threads, opsPerThread, [&](int t, uint64_t ops) {
+                                for (uint64_t i = 0; i < ops; ++i) {
+                                        logger.info(LogEvent::MessageRelayed, t, i);
+                                }
+                        });
+                        r.note = "descartadas " + std::to_string(logger.droppedCount());
+                        logger.shutdown();
+                        report(r);
+                }
+        }
+}
+
+void benchFraming() {
+        const auto messages = makeMessages(1000, 8, 300);
+
+        if (selected("framer.next_line")) {
+                std::string stream;
+                for (const auto& m : messages) {
+                        stream += m;
+                        stream += (m.size() % 3 == 0) ? "\r\n" : "\n";
+                }
+
+                LineFramer framer;
+                Result r = runThreads("framer.next_line", 1, 2000, [&](int, uint64_t ops) {
+                        std::string_view line;
+                        for (uint64_t i = 0; i < ops; ++i) {
+                                // Pedaços de 16 KiB, como o recv() do servidor
+                                for (size_t offset = 0; offset < stream.size(); offset += 16 * 1024) {
+                                        size_t n = std::min<size_t>(16 * 1024, stream.size() - offset);
+                                        framer.append(stream.data() + offset, n);
+                                        while (framer.nextLine(line)) {
+                                        }
+                                }
+                        }
+                });
+                // Uma operação = uma linha
+                normalize(r, messages.size());
+                report(r);
+        }
+
+        if (selected("encode.text_line")) {
+                report(runThreads("encode.text_line", 1, 1000000, [&](int, uint64_t ops) {
+                        for (uint64_t i = 0; i < ops; ++i) {
+                                SharedBuffer line = encodeChatLine(static_cast<int>(i % 1000), messages[i % messages.size()]);
+                        }
+                }));
+        }
+
+        if (selected("encode.binary_frame")) {
+                report(runThreads("encode.binary_frame", 1, 1000000, [&](int, uint64_t ops) {
+                        for (uint64_t i = 0; i < ops; ++i) {
+                                SharedBuffer frame = encodeFrame(FrameType::Chat, i, 7, messages[i % messages.size()]);
+                        }
+                }));
+        }
+
+        if (selected("decode.binary_frame")) {
+                std::string stream;
+                for (const auto& m : messages) {
+                        SharedBuffer frame = encodeFrame(FrameType::Chat, 1, 7, m);
+                        stream.append(frame->data(), frame->size());
+                }
+                Result r = runThreads("decode.binary_frame", 1, 2000, [&](int, uint64_t ops) {
+                        FrameHeader header;
+                        std::string_view payload;
+                        for (uint64_t i = 0; i < ops; ++i) {
+                                std::string_view data(stream);
+                                size_t consumed = 0;
+                                while (decodeFrame(data, header, payload, consumed) == DecodeStatus::Complete) {
+                                        data.remove_prefix(consumed);
+                                }
+                        }
+                });
+                normalize(r, messages.size());
+                report(r);
+        }
+
+        // Fan-out: um buffer compartilhado enfileirado em 64 destinatários (op = 1 destinatário)
+        if (selected("fanout.push64")) {
+                std::vector<std::unique_ptr<OutboundQueue>> queues;
+                for (int i = 0; i < 64; ++i) {
+                        queues.push_back(std::make_unique<OutboundQueue>(1024, SlowConsumerPolicy::DropOldest));
+                }
+                // Filas já cheias: cada push também descarta a mais antiga (regime permanente)
+                SharedBuffer filler = encodeChatLine(1, messages[0]);
+                for (auto& q : queues) {
+                        for (int i = 0; i < 1024; ++i) {
+                                q->push(filler);
+                        }
+                }
+
+                Result r = runThreads("fanout.push64", 1, 20000, [&](int, uint64_t ops) {
+                        for (uint64_t i = 0; i < ops; ++i) {
+                                SharedBuffer line = encodeChatLine(static_cast<int>(i % 1000), messages[i % messages.size()]);
+                                for (auto& q : queues) {
+                                        q->push(line);
+                                }
+                        }
+                });
+                normalize(r, queues.size());
+                report(r);
+        }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+        for (int i = 1; i < argc; ++i) {
+                std::string arg = argv[i];
+                if (arg.rfind("--filter=", 0) == 0) {
+                        filter = arg.substr(9);
+                } else if (arg.rfind("--scale=", 0) == 0) {
+                        scale = std::stod(arg.substr(8));
+                } else {
+                        std::cerr << "Uso: " << argv[0] << " [--filter=TEXTO] [--scale=F]" << std::endl;
+                        return 1;
+                }
+        }
+
+        std::printf("%-28s %4s %12s %10s %10s %10s  %s\n", "benchmark", "thr", "ops", "ns/op", "Mops/s", "allocs/op", "obs");
+        benchHistory();
+        benchSearch();
+        benchLogger();
+        benchFraming();
+        return 0;
+}
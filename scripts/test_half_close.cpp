@@ -0,0 +1,56 @@
+#include <arpa/inet.h>
+#include <cstring>
+#include <iostream>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Meio-fechamento: o cliente manda a última linha e o FIN juntos
+// (shutdown(SHUT_WR)). O servidor precisa ler o EOF e fechar a conexão,
+// mesmo que os dois cheguem no mesmo evento do epoll
+int main(int argc, char* argv[]) {
+        int port = argc > 1 ? std::stoi(argv[1]) : 8080;
+        int timeoutMs = 5000;
+
+        int sock = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in serverAddr{};
+        serverAddr.sin_family = AF_INET;
+        serverAddr.sin_port = htons(port);
+        inet_pton(AF_INET, "127.0.0.1", &serverAddr.sin_addr);
+
+        if (connect(sock, (sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+                std::cerr << "❌ Falha ao conectar na porta " << port << std::endl;
+                return 1;
+        }
+
+        // Espera as boas-vindas: o servidor já registrou a conexão
+        char buffer[4096];
+        pollfd pfd{sock, POLLIN, 0};
+        if (poll(&pfd, 1, timeoutMs) > 0) {
+                recv(sock, buffer, sizeof(buffer), 0);
+        }
+
+        const char* last = "bye msg\n";
+        send(sock, last, strlen(last), 0);
+        shutdown(sock, SHUT_WR);
+
+        // O servidor deve fechar do lado dele: recv() chega a 0
+        for (;;) {
+                if (poll(&pfd, 1, timeoutMs) <= 0) {
+                        std::cerr << "❌ Servidor não fechou a conexão em " << timeoutMs << " ms após o FIN"
+                                  << std::endl;
+                        close(sock);
+                        return 1;
+                }
+                ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+                if (n <= 0) {
+                        break;
+                }
+        }
+
+        close(sock);
+        std::cout << "✅ Meio-fechamento: servidor leu o EOF e fechou a conexão" << std::endl;
+        return 0;
+}
@@ -0,0 +1,155 @@
+#include "../lib/coro_socket.h"
+#include "../lib/memory_pool.h"
+#include <atomic>
+#include <cerrno>
+#include <new>
+#include <sys/socket.h>
+
+static std::atomic<size_t> liveFrames{0};
+static std::atomic<size_t> liveFrameBytes{0};
+
+CoroutineFrameStats coroutineFrameStats() {
+        return {liveFrames.load(std::memory_order_relaxed), liveFrameBytes.load(std::memory_order_relaxed)};
+}
+
+// Quadros vêm do BufferPool: uma conexão nova reaproveita o quadro de uma que fechou
+void* DetachedTask::promise_type::operator new(size_t size) {
+        void* frame = BufferPool::instance().allocate(size);
+        liveFrames.fetch_add(1, std::memory_order_relaxed);
+        liveFrameBytes.fetch_add(size, std::memory_order_relaxed);
+        return frame;
+}
+
+void DetachedTask::promise_type::operator delete(void* frame, size_t size) noexcept {
+        liveFrames.fetch_sub(1, std::memory_order_relaxed);
+        liveFrameBytes.fetch_sub(size, std::memory_order_relaxed);
+        BufferPool::instance().release(frame, size);
+}
+
+AsyncSocket::AsyncSocket(EventLoop& l, int fd, uint32_t events) : loop(l), socketFd(fd), registered(false) {
+        registered = loop.add(socketFd, events, [this](uint32_t ready) { onEvent(ready); });
+}
+
+AsyncSocket::~AsyncSocket() {
+        *alive = false;
+        if (registered) {
+                loop.remove(socketFd);
+        }
+}
+
+void AsyncSocket::Operation::await_suspend(std::coroutine_handle<> handle) {
+        waiting = handle;
+        (write ? socket.writer : socket.reader) = this;
+}
+
+bool AsyncSocket::RecvOperation::attempt() {
+        for (;;) {
+                ssize_t n = ::recv(socket.socketFd, buffer, length, 0);
+                if (n < 0 && errno == EINTR) {
+                        continue;
+                }
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                        socket.mayHaveData = false;
+                        return false;
+                }
+                // Leitura curta: o buffer do kernel ficou vazio e só um novo evento traz mais.
+                // Exceto se o par já fechou: o FIN veio no mesmo evento e não haverá outra borda
+                if (n > 0 && static_cast<size_t>(n) < length) {
+                        socket.mayHaveData = socket.peerClosed;
+                }
+                result = n;
+                return true;
+        }
+}
+
+bool AsyncSocket::ReadableOperation::attempt() {
+        result = 1;
+        return socket.mayHaveData;
+}
+
+bool AsyncSocket::SendOperation::attempt() {
+        while (sent < data.size()) {
+                ssize_t n = ::send(socket.socketFd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR) {
+                        continue;
+                }
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                        return false;
+                }
+                if (n < 0) {
+                        result = -1;
+                        return true;
+                }
+                sent += static_cast<size_t>(n);
+        }
+        result = static_cast<ssize_t>(sent);
+        return true;
+}
+
+bool AsyncSocket::AcceptOperation::attempt() {
+        for (;;) {
+                int fd = accept4(socket.socketFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0 && (errno == EINTR || errno == ECONNABORTED)) {
+                        continue;
+                }
+                if (fd < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                        return false;
+                }
+                result = fd;
+                return true;
+        }
+}
+
+// Esvazia o slot antes de retomar: a corrotina pode aguardar de novo na mesma chamada
+void AsyncSocket::complete(Operation*& slot) {
+        std::coroutine_handle<> handle = slot->waiting;
+        slot = nullptr;
+        handle.resume();
+}
+
+void AsyncSocket::onEvent(uint32_t events) {
+        std::shared_ptr<bool> guard = alive;
+
+        if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                mayHaveData = true;
+        }
+        if (events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                peerClosed = true;
+        }
+
+        if (mayHaveData && reader && reader->attempt()) {
+                complete(reader);
+                if (!*guard) {
+                        return; // a corrotina terminou e levou este objeto junto
+                }
+        }
+
+        if (events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) {
+                if (writer) {
+                        if (writer->attempt()) {
+                                complete(writer);
+                        }
+                } else if (writableHandler) {
+                        writableHandler();
+                }
+        }
+}
+
+void AsyncSocket::cancel() {
+        std::shared_ptr<bool> guard = alive;
+
+        if (reader) {
+                reader->result = -1;
+                errno = ECANCELED;
+                complete(reader);
+                if (!*guard) {
+                        return;
+                }
+        }
+
+        if (writer) {
+                writer->result = -1;
+                errno = ECANCELED;
+                complete(writer);
+        }
+}
@@ -0,0 +1,80 @@
+#include "../lib/event_loop.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+bool setNonBlocking(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        if (flags < 0) {
+                return false;
+        }
+        return fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+EventLoop::EventLoop(size_t maxEvents)
+    : epollFd(epoll_create1(EPOLL_CLOEXEC)), readyEvents(maxEvents) {
+}
+
+EventLoop::~EventLoop() {
+        if (epollFd >= 0) {
+                close(epollFd);
+        }
+}
+
+bool EventLoop::add(int fd, uint32_t events, Handler handler) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+                return false;
+        }
+
+        handlers[fd] = std::make_shared<Handler>(std::move(handler));
+        return true;
+}
+
+bool EventLoop::modify(int fd, uint32_t events) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+        return epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+void EventLoop::remove(int fd) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        handlers.erase(fd);
+}
+
+int EventLoop::poll(int timeoutMs) {
+        // Sem temporizadores a espera é a pedida; com eles, nunca passa do próximo vencimento
+        if (wheel.size() > 0) {
+                int due = wheel.timeoutMs(TimerWheel::Clock::now());
+                if (due >= 0 && (timeoutMs < 0 || due < timeoutMs)) {
+                        timeoutMs = due;
+                }
+        }
+
+        int n = epoll_wait(epollFd, readyEvents.data(), static_cast<int>(readyEvents.size()), timeoutMs);
+
+        if (n < 0) {
+                return errno == EINTR ? 0 : -1;
+        }
+
+        for (int i = 0; i < n; ++i) {
+                auto it = handlers.find(readyEvents[i].data.fd);
+                if (it == handlers.end()) {
+                        continue; // fd removido por um handler anterior neste lote
+                }
+
+                // Mantém o handler vivo mesmo que ele remova o próprio fd
+                std::shared_ptr<Handler> handler = it->second;
+                (*handler)(readyEvents[i].events);
+        }
+
+        if (wheel.size() > 0) {
+                wheel.advance(TimerWheel::Clock::now());
+        }
+
+        return n;
+}
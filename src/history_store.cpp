@@ -0,0 +1,436 @@
+#include "../lib/history_store.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Cabeçalho de cada registro no segmento, seguido de 'length' bytes da linha
+struct RecordHeader {
+        uint32_t magic;
+        uint32_t length;
+        int64_t timestampNs;
+        uint64_t sequence;
+        uint32_t checksum; // FNV-1a de length, timestampNs, sequence e da linha
+        uint32_t reserved;
+};
+
+static_assert(sizeof(RecordHeader) == 32, "formato do segmento em disco");
+
+static constexpr uint32_t RECORD_MAGIC = 0x52545348; // "HSTR"
+static constexpr uint32_t MAX_RECORD_BYTES = 1024 * 1024;
+// Lote pendente máximo por sala; acima disso o disco não acompanha e o registro é descartado
+static constexpr size_t MAX_PENDING_BYTES = 8 * 1024 * 1024;
+static constexpr const char* SEGMENT_SUFFIX = ".seg";
+// Sem gravar por esse tempo, o segmento ativo é fechado até o próximo lote
+static constexpr std::chrono::seconds IDLE_CLOSE(5);
+
+static uint32_t fnv1a(uint32_t hash, const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+                hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+}
+
+static uint32_t recordChecksum(const RecordHeader& header, const char* line) {
+        uint32_t length = header.length;
+        uint32_t hash = 2166136261u;
+        hash = fnv1a(hash, &length, sizeof(length));
+        hash = fnv1a(hash, &header.timestampNs, sizeof(header.timestampNs));
+        hash = fnv1a(hash, &header.sequence, sizeof(header.sequence));
+        return fnv1a(hash, line, length);
+}
+
+// Garante que a criação de um segmento sobreviva a uma queda
+static void syncDirectory(const std::string& directory) {
+        int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd >= 0) {
+                fsync(fd);
+                close(fd);
+        }
+}
+
+static bool ensureDirectory(const std::string& directory) {
+        return mkdir(directory.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+HistoryStore::HistoryStore(std::string dir, size_t segment)
+    : directory(std::move(dir)), segmentBytes(segment ? segment : 1) {
+        ensureDirectory(directory);
+}
+
+HistoryStore::~HistoryStore() {
+        if (activeFd >= 0) {
+                close(activeFd);
+        }
+}
+
+std::string HistoryStore::segmentPath(uint64_t number) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llu%s", static_cast<unsigned long long>(number), SEGMENT_SUFFIX);
+        return directory + "/" + name;
+}
+
+std::vector<uint64_t> HistoryStore::listSegments() const {
+        std::vector<uint64_t> numbers;
+        DIR* dir = opendir(directory.c_str());
+        if (!dir) {
+                return numbers;
+        }
+
+        while (dirent* entry = readdir(dir)) {
+                std::string_view name(entry->d_name);
+                if (name.size() != 16 + std::strlen(SEGMENT_SUFFIX) || name.substr(16) != SEGMENT_SUFFIX) {
+                        continue;
+                }
+                char* end = nullptr;
+                uint64_t number = std::strtoull(entry->d_name, &end, 10);
+                if (end == entry->d_name + 16) {
+                        numbers.push_back(number);
+                }
+        }
+        closedir(dir);
+
+        std::sort(numbers.begin(), numbers.end());
+        return numbers;
+}
+
+bool HistoryStore::openSegment(uint64_t number) {
+        if (activeFd >= 0) {
+                close(activeFd);
+                activeFd = -1;
+        }
+
+        std::string path = segmentPath(number);
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+                errors.fetch_add(1, std::memory_order_relaxed);
+                return false;
+        }
+
+        struct stat info;
+        activeSize = fstat(fd, &info) == 0 ? static_cast<size_t>(info.st_size) : 0;
+        if (activeSize == 0) {
+                syncDirectory(directory);
+        }
+
+        activeFd = fd;
+        activeNumber = number;
+        parked = false;
+        lastWrite = std::chrono::steady_clock::now();
+        return true;
+}
+
+size_t HistoryStore::scanSegment(const char* data, size_t size, std::vector<size_t>& offsets) {
+        size_t offset = 0;
+        while (offset + sizeof(RecordHeader) <= size) {
+                RecordHeader header;
+                std::memcpy(&header, data + offset, sizeof(header));
+                if (header.magic != RECORD_MAGIC || header.length > MAX_RECORD_BYTES ||
+                    offset + sizeof(header) + header.length > size) {
+                        break;
+                }
+
+                const char* line = data + offset + sizeof(header);
+                if (recordChecksum(header, line) != header.checksum) {
+                        break;
+                }
+
+                offsets.push_back(offset);
+                offset += sizeof(header) + header.length;
+        }
+        return offset;
+}
+
+size_t HistoryStore::recover(size_t count, const std::function<void(const StoredMessage&)>& fn) {
+        struct Mapped {
+                const char* data = nullptr;
+                size_t size = 0;
+                std::vector<size_t> offsets;
+        };
+
+        std::vector<uint64_t> segments = listSegments();
+        if (segments.empty()) {
+                openSegment(1);
+                return 0;
+        }
+
+        // Do segmento mais novo para o mais antigo, até cobrir a janela pedida
+        std::vector<Mapped> mapped;
+        size_t total = 0;
+        size_t activeEnd = 0;
+        for (size_t i = segments.size(); i-- > 0 && (total < count || mapped.empty());) {
+                bool newest = i + 1 == segments.size();
+                std::string path = segmentPath(segments[i]);
+                int fd = open(path.c_str(), (newest ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+                if (fd < 0) {
+                        errors.fetch_add(1, std::memory_order_relaxed);
+                        break;
+                }
+
+                Mapped segment;
+                struct stat info{};
+                if (fstat(fd, &info) == 0 && info.st_size > 0) {
+                        void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                        if (data != MAP_FAILED) {
+                                segment.data = static_cast<const char*>(data);
+                                segment.size = static_cast<size_t>(info.st_size);
+                        }
+                }
+
+                size_t validEnd = segment.data ? scanSegment(segment.data, segment.size, segment.offsets) : 0;
+                if (newest) {
+                        // Só o fim do segmento ativo pode ter uma escrita interrompida
+                        if (validEnd < static_cast<size_t>(info.st_size) && ftruncate(fd, static_cast<off_t>(validEnd)) != 0) {
+                                errors.fetch_add(1, std::memory_order_relaxed);
+                        }
+                        activeEnd = validEnd;
+                }
+                close(fd);
+
+                total += segment.offsets.size();
+                mapped.push_back(std::move(segment));
+                recoveredSegments++;
+        }
+
+        // 'mapped' está do mais novo para o mais antigo: entrega na ordem inversa
+        size_t skip = total > count ? total - count : 0;
+        size_t delivered = 0;
+        for (size_t i = mapped.size(); i-- > 0;) {
+                const Mapped& segment = mapped[i];
+                for (size_t offset : segment.offsets) {
+                        if (skip > 0) {
+                                skip--;
+                                continue;
+                        }
+                        RecordHeader header;
+                        std::memcpy(&header, segment.data + offset, sizeof(header));
+                        fn(StoredMessage{header.sequence, header.timestampNs,
+                                         std::string_view(segment.data + offset + sizeof(header), header.length)});
+                        delivered++;
+                }
+        }
+
+        for (const Mapped& segment : mapped) {
+                if (segment.data) {
+                        munmap(const_cast<char*>(segment.data), segment.size);
+                }
+        }
+
+        uint64_t last = segments.back();
+        openSegment(activeEnd >= segmentBytes ? last + 1 : last);
+        return delivered;
+}
+
+bool HistoryStore::append(uint64_t sequence, int64_t timestampNs, std::string_view line) {
+        RecordHeader header{};
+        header.magic = RECORD_MAGIC;
+        header.length = static_cast<uint32_t>(std::min<size_t>(line.size(), MAX_RECORD_BYTES));
+        header.timestampNs = timestampNs;
+        header.sequence = sequence;
+        header.checksum = recordChecksum(header, line.data());
+
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        if (pending.size() + sizeof(header) + header.length > MAX_PENDING_BYTES) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+        }
+        pending.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        pending.append(line.data(), header.length);
+        appended.fetch_add(1, std::memory_order_relaxed);
+        return true;
+}
+
+// Registros inteiros em um lote (cabeçalho + linha cada)
+static uint64_t countRecords(const std::string& batch) {
+        uint64_t records = 0;
+        size_t offset = 0;
+        while (offset + sizeof(RecordHeader) <= batch.size()) {
+                RecordHeader header;
+                std::memcpy(&header, batch.data() + offset, sizeof(header));
+                offset += sizeof(header) + header.length;
+                records++;
+        }
+        return records;
+}
+
+// Devolve o lote que falhou para a frente do pendente: a próxima rodada tenta
+// de novo, na ordem original. Se não couber no limite, conta os registros como descartados
+void HistoryStore::restoreBatch() {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        if (writing.size() + pending.size() <= MAX_PENDING_BYTES) {
+                writing.append(pending);
+                pending.swap(writing);
+        } else {
+                dropped.fetch_add(countRecords(writing), std::memory_order_relaxed);
+        }
+        writing.clear();
+}
+
+void HistoryStore::commit() {
+        {
+                std::lock_guard<std::mutex> lock(pendingMutex);
+                writing.swap(pending);
+        }
+
+        if (writing.empty()) {
+                if (activeFd >= 0 && std::chrono::steady_clock::now() - lastWrite >= IDLE_CLOSE) {
+                        close(activeFd);
+                        activeFd = -1;
+                        parked = true;
+                }
+                return;
+        }
+
+        // Fechado por ociosidade: continua no mesmo segmento
+        if (parked && !openSegment(activeNumber)) {
+                restoreBatch();
+                return;
+        }
+
+        if (activeSize > 0 && activeSize + writing.size() > segmentBytes) {
+                openSegment(activeNumber + 1);
+        }
+
+        // Segmento indisponível (abertura falhou antes): tenta um novo
+        if (activeFd < 0 && !openSegment(activeNumber + 1)) {
+                restoreBatch();
+                return;
+        }
+
+        size_t done = 0;
+        bool failed = false;
+        while (done < writing.size()) {
+                ssize_t n = write(activeFd, writing.data() + done, writing.size() - done);
+                if (n < 0 && errno == EINTR) {
+                        continue;
+                }
+                if (n <= 0) {
+                        failed = true;
+                        break;
+                }
+                done += static_cast<size_t>(n);
+        }
+
+        // Um fdatasync por lote, não por mensagem. Se falhar, o kernel pode já ter
+        // descartado as páginas: o lote é tratado como não gravado
+        if (!failed && fdatasync(activeFd) != 0) {
+                failed = true;
+        }
+        syncs.fetch_add(1, std::memory_order_relaxed);
+
+        if (failed) {
+                errors.fetch_add(1, std::memory_order_relaxed);
+                // Corta o registro rasgado: o recover() para no primeiro checksum
+                // inválido e perderia tudo o que fosse gravado depois dele no segmento.
+                // Sem o corte, o próximo lote vai para um segmento novo
+                if (ftruncate(activeFd, static_cast<off_t>(activeSize)) != 0) {
+                        errors.fetch_add(1, std::memory_order_relaxed);
+                        openSegment(activeNumber + 1);
+                }
+                restoreBatch();
+                return;
+        }
+
+        written.fetch_add(done, std::memory_order_relaxed);
+        activeSize += done;
+        lastWrite = std::chrono::steady_clock::now();
+        writing.clear();
+}
+
+HistoryJournal::HistoryJournal(std::string dir, std::chrono::milliseconds interval, size_t segment)
+    : directory(std::move(dir)), commitInterval(interval), segmentBytes(segment) {
+        ready = ensureDirectory(directory);
+        if (ready) {
+                committer = std::thread(&HistoryJournal::run, this);
+        }
+}
+
+HistoryJournal::~HistoryJournal() {
+        {
+                std::lock_guard<std::mutex> lock(stopMutex);
+                stopping = true;
+        }
+        stopCondition.notify_all();
+        if (committer.joinable()) {
+                committer.join();
+        }
+}
+
+std::shared_ptr<HistoryStore> HistoryJournal::open(
+        const std::string& room, const std::function<void(const std::shared_ptr<HistoryStore>&)>& recover) {
+        auto store = std::make_shared<HistoryStore>(directory + "/" + room, segmentBytes);
+        recover(store);
+
+        std::lock_guard<std::mutex> lock(storesMutex);
+        stores.push_back(store);
+        return store;
+}
+
+std::vector<std::string> HistoryJournal::existingRooms() const {
+        std::vector<std::string> rooms;
+        DIR* dir = opendir(directory.c_str());
+        if (!dir) {
+                return rooms;
+        }
+
+        while (dirent* entry = readdir(dir)) {
+                if (entry->d_name[0] == '.') {
+                        continue;
+                }
+                struct stat info;
+                std::string path = directory + "/" + entry->d_name;
+                if (stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+                        rooms.emplace_back(entry->d_name);
+                }
+        }
+        closedir(dir);
+
+        std::sort(rooms.begin(), rooms.end());
+        return rooms;
+}
+
+HistoryJournal::Stats HistoryJournal::stats() const {
+        Stats total{};
+        std::lock_guard<std::mutex> lock(storesMutex);
+        for (const auto& store : stores) {
+                total.appended += store->appendedCount();
+                total.dropped += store->droppedCount();
+                total.syncs += store->syncCount();
+                total.bytesWritten += store->bytesWritten();
+                total.errors += store->errorCount();
+        }
+        return total;
+}
+
+// A cada intervalo descarrega todas as salas; no encerramento faz a última rodada
+void HistoryJournal::run() {
+        std::vector<std::shared_ptr<HistoryStore>> snapshot;
+        for (;;) {
+                bool stop;
+                {
+                        std::unique_lock<std::mutex> lock(stopMutex);
+                        stopCondition.wait_for(lock, commitInterval, [this] { return stopping; });
+                        stop = stopping;
+                }
+
+                {
+                        std::lock_guard<std::mutex> lock(storesMutex);
+                        snapshot = stores;
+                }
+                for (const auto& store : snapshot) {
+                        store->commit();
+                }
+                snapshot.clear();
+
+                if (stop) {
+                        return;
+                }
+        }
+}
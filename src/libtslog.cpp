@@ -1,60 +1,220 @@
 #include "../lib/libtslog.h"
 #include "../lib/logEntry.h"
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <unistd.h>
 
-ThreadSafeLogger::ThreadSafeLogger() : running(false) {
+ThreadSafeLogger::ThreadSafeLogger() : ring(new LogSlot[LOG_RING_CAPACITY]), running(false) {
+        static_assert((LOG_RING_CAPACITY & (LOG_RING_CAPACITY - 1)) == 0, "LOG_RING_CAPACITY deve ser potência de 2");
+        for (size_t i = 0; i < LOG_RING_CAPACITY; ++i) {
+                ring[i].sequence.store(i, std::memory_order_relaxed);
+        }
 }
 
 ThreadSafeLogger::~ThreadSafeLogger() {
         shutdown();
 }
 
-void ThreadSafeLogger::initialize(const std::string& filename) {
-        logFile.open(filename, std::ios::app);
+// Um log binário de outra versão não recebe registros novos no fim (o
+// decodificador leria tudo com o formato do cabeçalho): vai para <arquivo>.v<N>
+void ThreadSafeLogger::keepOlderVersion(const std::string& filename) {
+        std::ifstream existing(filename, std::ios::binary);
+        char header[LOG_FILE_HEADER_SIZE];
+        if (!existing.read(header, sizeof(header))) {
+                return;
+        }
+
+        uint8_t version = logFileVersion(std::string_view(header, sizeof(header)));
+        if (version != LOG_FILE_VERSION) {
+                existing.close();
+                std::string kept = filename + ".v" + std::to_string(version);
+                if (std::rename(filename.c_str(), kept.c_str()) == 0) {
+                        std::cerr << "Log " << filename << " de outra versão movido para " << kept << std::endl;
+                }
+        }
+}
+
+void ThreadSafeLogger::initialize(const std::string& filename, LogOutput outputFormat) {
+        std::ios::openmode mode = std::ios::app;
+        if (outputFormat == LogOutput::Binary) {
+                mode |= std::ios::binary;
+                keepOlderVersion(filename);
+        }
+        logFile.open(filename, mode);
         if (!logFile.is_open()) {
                 std::cerr << "Failed to open log file: " << filename << std::endl;
                 return;
         }
+
+        output = outputFormat;
+        if (output == LogOutput::Binary && logFile.tellp() == 0) {
+                std::string header;
+                appendLogFileHeader(header);
+                logFile.write(header.data(), static_cast<std::streamsize>(header.size()));
+        }
+
         running = true;
         logThread = std::thread(&ThreadSafeLogger::logWriterFunc, this);
 }
 
 void ThreadSafeLogger::log(const std::string& message) {
-        LogEntry entry;
-        entry.timestamp = std::chrono::system_clock::now();
-        entry.threadId = std::this_thread::get_id();
-        entry.message = message;
+        info(LogEvent::Text, message);
+}
+
+// Sem travas: reserva um slot com CAS; com o anel cheio a entrada nova
+// é descartada e contabilizada
+ThreadSafeLogger::LogSlot* ThreadSafeLogger::acquireSlot(size_t& pos) {
+        pos = enqueuePos.load(std::memory_order_relaxed);
+
+        for (;;) {
+                LogSlot* slot = &ring[pos & (LOG_RING_CAPACITY - 1)];
+                size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+                if (diff == 0) {
+                        if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                                return slot;
+                        }
+                } else if (diff < 0) {
+                        dropped.fetch_add(1, std::memory_order_relaxed);
+                        return nullptr;
+                } else {
+                        pos = enqueuePos.load(std::memory_order_relaxed);
+                }
+        }
+}
+
+void ThreadSafeLogger::publishSlot(LogSlot& slot, size_t pos) {
+        static thread_local const uint64_t threadId = static_cast<uint64_t>(gettid());
+
+        slot.timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        slot.threadId = threadId;
+        slot.sequence.store(pos + 1, std::memory_order_seq_cst);
+
+        if (writerSleeping.load(std::memory_order_seq_cst)) {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                logCondition.notify_one();
+        }
+}
+
+void ThreadSafeLogger::encodeString(LogSlot& slot, std::string_view text) {
+        size_t room = LOG_MAX_ARGS - slot.length;
+        if (room < 3) {
+                truncated.fetch_add(1, std::memory_order_relaxed);
+                return;
+        }
+
+        size_t length = text.size();
+        if (length > room - 3) {
+                length = room - 3;
+                truncated.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        uint16_t raw = static_cast<uint16_t>(length);
+        slot.args[slot.length] = LOG_ARG_STR;
+        std::memcpy(slot.args + slot.length + 1, &raw, sizeof(raw));
+        std::memcpy(slot.args + slot.length + 3, text.data(), length);
+        slot.length = static_cast<uint16_t>(slot.length + 3 + length);
+        slot.argCount++;
+}
+
+bool ThreadSafeLogger::tryPop(LogEntry& entry) {
+        LogSlot& slot = ring[dequeuePos & (LOG_RING_CAPACITY - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1) {
+                return false;
+        }
+
+        entry.timestampNs = slot.timestampNs;
+        entry.threadId = slot.threadId;
+        entry.event = slot.event;
+        entry.level = static_cast<LogLevel>(slot.level);
+        entry.argCount = slot.argCount;
+        entry.args.assign(slot.args, slot.length);
+
+        // Libera o slot para a próxima volta do anel
+        slot.sequence.store(dequeuePos + LOG_RING_CAPACITY, std::memory_order_release);
+        dequeuePos++;
+        return true;
+}
 
-        std::unique_lock<std::mutex> lock(logMutex);
-        if (logQueue.size() >= MAX_LOG_QUEUE_SIZE) {
-                logQueue.pop();
+// Coalesce até LOG_WRITE_BATCH registros em um único buffer
+size_t ThreadSafeLogger::drainBatch(std::string& out) {
+        LogEntry entry;
+        size_t count = 0;
+        while (count < LOG_WRITE_BATCH && tryPop(entry)) {
+                if (output == LogOutput::Binary) {
+                        appendLogRecord(out, entry);
+                } else {
+                        formatter.format(entry, out);
+                }
+                count++;
         }
-        logQueue.push(entry);
-        logCondition.notify_one();
+        return count;
 }
 
 void ThreadSafeLogger::logWriterFunc() {
-        while (running || !logQueue.empty()) {
-                std::unique_lock<std::mutex> lock(logMutex);
-                logCondition.wait(lock, [this] { return !logQueue.empty() || !running; });
+        std::string batch;
+        batch.reserve(LOG_WRITE_BATCH * 128);
+
+        for (;;) {
+                batch.clear();
+                if (drainBatch(batch) > 0) {
+                        // Uma escrita e um flush por lote, em vez de std::endl por linha
+                        logFile.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+                        logFile.flush();
+                        continue;
+                }
+
+                if (!running) {
+                        break;
+                }
+
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                writerSleeping.store(true, std::memory_order_seq_cst);
+                // Reconfere após anunciar o sono: um produtor que publicou antes não notificou
+                LogSlot& next = ring[dequeuePos & (LOG_RING_CAPACITY - 1)];
+                if (next.sequence.load(std::memory_order_seq_cst) != dequeuePos + 1 && running) {
+                        logCondition.wait_for(lock, std::chrono::milliseconds(100));
+                }
+                writerSleeping.store(false, std::memory_order_relaxed);
+        }
 
-                while (!logQueue.empty()) {
-                        LogEntry entry = logQueue.front();
-                        logQueue.pop();
-                        lock.unlock();
+        // Registro final com o total descartado, no formato do arquivo
+        uint64_t lost = dropped.load();
+        if (lost > 0) {
+                LogEntry entry;
+                entry.timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count();
+                entry.threadId = static_cast<uint64_t>(gettid());
+                entry.level = LogLevel::Warn;
 
-                        auto time = std::chrono::system_clock::to_time_t(entry.timestamp);
-                        logFile << std::ctime(&time) << " [Thread " << entry.threadId << "] " << entry.message << std::endl;
+                std::string text = "[Logger] " + std::to_string(lost) + " entradas descartadas (anel cheio)";
+                uint16_t length = static_cast<uint16_t>(text.size());
+                entry.argCount = 1;
+                entry.args.push_back(LOG_ARG_STR);
+                entry.args.append(reinterpret_cast<const char*>(&length), sizeof(length));
+                entry.args += text;
 
-                        lock.lock();
+                batch.clear();
+                if (output == LogOutput::Binary) {
+                        appendLogRecord(batch, entry);
+                } else {
+                        formatter.format(entry, batch);
                 }
+                logFile.write(batch.data(), static_cast<std::streamsize>(batch.size()));
         }
+        logFile.flush();
 }
 
 void ThreadSafeLogger::shutdown() {
         if (!running)
                 return;
-        running = false;
+        {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                running = false;
+        }
         logCondition.notify_all();
 
         if (logThread.joinable()) {
@@ -63,4 +223,4 @@ void ThreadSafeLogger::shutdown() {
         if (logFile.is_open()) {
                 logFile.close();
         }
-}
\ No newline at end of file
+}
@@ -0,0 +1,108 @@
+#include "../lib/line_framer.h"
+#include "../lib/memory_pool.h"
+#include <cstring>
+
+LineFramer::LineFramer(size_t maxLine) : maxLineLength(maxLine ? maxLine : 1) {
+}
+
+LineFramer::~LineFramer() {
+        BufferPool::instance().release(buffer, capacity);
+}
+
+char* LineFramer::prepareWrite(size_t minSpace) {
+        if (capacity - writePos >= minSpace) {
+                return buffer + writePos;
+        }
+
+        // Compacta: move a linha incompleta para o início (custo limitado ao seu tamanho)
+        size_t pending = writePos - readPos;
+        if (readPos > 0) {
+                std::memmove(buffer, buffer + readPos, pending);
+                scanPos -= readPos;
+                writePos = pending;
+                readPos = 0;
+        }
+
+        if (capacity - writePos < minSpace) {
+                size_t newSize = capacity ? capacity : minSpace;
+                while (newSize - writePos < minSpace) {
+                        newSize *= 2;
+                }
+
+                BufferPool& pool = BufferPool::instance();
+                char* grown = static_cast<char*>(pool.allocate(newSize));
+                if (writePos > 0) {
+                        std::memcpy(grown, buffer, writePos);
+                }
+                pool.release(buffer, capacity);
+                buffer = grown;
+                capacity = newSize;
+        }
+
+        return buffer + writePos;
+}
+
+void LineFramer::commitWrite(size_t n) {
+        writePos += n;
+}
+
+void LineFramer::append(const char* data, size_t n) {
+        std::memcpy(prepareWrite(n), data, n);
+        commitWrite(n);
+}
+
+void LineFramer::consume(size_t n) {
+        readPos += n;
+        if (scanPos < readPos) {
+                scanPos = readPos;
+        }
+        if (readPos == writePos) {
+                readPos = scanPos = writePos = 0;
+        }
+}
+
+bool LineFramer::nextLine(std::string_view& line) {
+        const char* base = buffer;
+
+        // memchr da glibc usa instruções vetoriais (SSE2/AVX2) em blocos grandes
+        const void* found = std::memchr(base + scanPos, '\n', writePos - scanPos);
+
+        size_t length;
+        size_t next;
+        size_t scanned;
+        if (found) {
+                size_t newline = static_cast<const char*>(found) - base;
+                length = newline - readPos;
+                if (length > 0 && base[newline - 1] == '\r') {
+                        --length;
+                }
+                next = newline + 1;
+                scanned = next;
+                if (length > maxLineLength) {
+                        // O '\n' já está no buffer, mas a linha passa do limite: entrega
+                        // um pedaço e lembra onde está o '\n' para não procurá-lo de novo
+                        length = maxLineLength;
+                        next = readPos + maxLineLength;
+                        scanned = newline;
+                }
+        } else if (writePos - readPos >= maxLineLength) {
+                // Linha longa demais: entrega um pedaço para limitar a memória
+                length = maxLineLength;
+                next = readPos + maxLineLength;
+                scanned = next;
+        } else {
+                scanPos = writePos;
+                return false;
+        }
+
+        line = std::string_view(base + readPos, length);
+        readPos = next;
+        scanPos = scanned;
+
+        // Tudo consumido: volta ao início sem precisar de memmove
+        if (readPos == writePos) {
+                readPos = scanPos = writePos = 0;
+        }
+
+        return true;
+}
@@ -0,0 +1,157 @@
+// Decodificador offline dos logs binários do libtslog
+// Uso: log_decoder [--follow | --summary] [--level=debug|info|warn|error] arquivo.bin
+#include "../lib/log_events.h"
+#include "../lib/log_record.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+enum class DecoderMode {
+        Print,
+        Follow,
+        Summary
+};
+
+void printSummary(const std::vector<uint64_t>& counts, uint64_t total, int64_t firstNs, int64_t lastNs) {
+        std::cout << "Registros: " << total << std::endl;
+        if (total > 1) {
+                std::cout << "Intervalo: " << (lastNs - firstNs) / 1000000000 << " s" << std::endl;
+        }
+
+        std::vector<std::pair<uint64_t, size_t>> ranked;
+        for (size_t id = 0; id < counts.size(); ++id) {
+                if (counts[id] > 0) {
+                        ranked.emplace_back(counts[id], id);
+                }
+        }
+        std::sort(ranked.rbegin(), ranked.rend());
+
+        for (const auto& entry : ranked) {
+                const char* name = logEventName(static_cast<uint16_t>(entry.second));
+                std::cout << "   " << (name ? name : "Desconhecido") << ": " << entry.first << std::endl;
+        }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+        DecoderMode mode = DecoderMode::Print;
+        LogLevel minLevel = LogLevel::Debug;
+        std::string path;
+
+        for (int i = 1; i < argc; ++i) {
+                std::string arg = argv[i];
+                if (arg == "--follow") {
+                        mode = DecoderMode::Follow;
+                } else if (arg == "--summary") {
+                        mode = DecoderMode::Summary;
+                } else if (arg.rfind("--level=", 0) == 0 && parseLogLevel(arg.substr(8), minLevel)) {
+                        continue;
+                } else if (path.empty() && arg.rfind("--", 0) != 0) {
+                        path = arg;
+                } else {
+                        path.clear();
+                        break;
+                }
+        }
+
+        if (path.empty()) {
+                std::cerr << "Uso: " << argv[0] << " [--follow | --summary] [--level=debug|info|warn|error] arquivo.bin" << std::endl;
+                return 1;
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+                std::cerr << "Não foi possível abrir " << path << std::endl;
+                return 1;
+        }
+
+        std::string buffer;
+        size_t offset = 0;
+        bool headerChecked = false;
+        uint8_t version = 0;
+        LogFormatter formatter;
+        LogEntry entry;
+        std::string line;
+
+        std::vector<uint64_t> counts(static_cast<size_t>(LogEvent::Count) + 1, 0);
+        uint64_t total = 0;
+        int64_t firstNs = 0;
+        int64_t lastNs = 0;
+
+        char chunk[64 * 1024];
+        for (;;) {
+                file.read(chunk, sizeof(chunk));
+                std::streamsize got = file.gcount();
+                if (got > 0) {
+                        buffer.erase(0, offset);
+                        offset = 0;
+                        buffer.append(chunk, static_cast<size_t>(got));
+                }
+
+                if (!headerChecked && buffer.size() >= LOG_FILE_HEADER_SIZE) {
+                        version = logFileVersion(buffer);
+                        if (version == 0) {
+                                std::cerr << path << " não é um log binário do libtslog (versões 1 a "
+                                          << static_cast<int>(LOG_FILE_VERSION) << ")" << std::endl;
+                                return 1;
+                        }
+                        offset = LOG_FILE_HEADER_SIZE;
+                        headerChecked = true;
+                }
+
+                while (headerChecked) {
+                        size_t consumed = 0;
+                        RecordStatus status = readLogRecord(std::string_view(buffer).substr(offset), entry, consumed, version);
+                        if (status == RecordStatus::Invalid) {
+                                std::cerr << "Registro inválido no byte " << offset << std::endl;
+                                return 1;
+                        }
+                        if (status == RecordStatus::Incomplete) {
+                                break;
+                        }
+                        offset += consumed;
+
+                        if (entry.level < minLevel) {
+                                continue;
+                        }
+
+                        if (mode == DecoderMode::Summary) {
+                                counts[std::min<size_t>(entry.event, counts.size() - 1)]++;
+                                if (total++ == 0) {
+                                        firstNs = entry.timestampNs;
+                                }
+                                lastNs = entry.timestampNs;
+                        } else {
+                                line.clear();
+                                formatter.format(entry, line);
+                                std::cout << line;
+                        }
+                }
+
+                if (got > 0) {
+                        continue;
+                }
+
+                if (mode != DecoderMode::Follow) {
+                        break;
+                }
+
+                // Fim atual do arquivo: aguarda o servidor gravar mais registros
+                std::cout.flush();
+                file.clear();
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+
+        if (mode == DecoderMode::Summary) {
+                printSummary(counts, total, firstNs, lastNs);
+        }
+        return 0;
+}
@@ -0,0 +1,163 @@
+#include "../lib/log_record.h"
+#include "../lib/log_events.h"
+#include <cstring>
+
+namespace {
+
+template<typename T>
+void appendRaw(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+T readRaw(const char* data) {
+        T value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+}
+
+// Anexa o próximo argumento; retorna false quando não há mais nenhum
+bool appendNextArg(std::string_view& args, std::string& out) {
+        if (args.empty()) {
+                return false;
+        }
+
+        char tag = args[0];
+        if (tag == LOG_ARG_INT && args.size() >= 9) {
+                out += std::to_string(readRaw<int64_t>(args.data() + 1));
+                args.remove_prefix(9);
+                return true;
+        }
+        if (tag == LOG_ARG_STR && args.size() >= 3) {
+                size_t length = readRaw<uint16_t>(args.data() + 1);
+                if (args.size() >= 3 + length) {
+                        out.append(args.data() + 3, length);
+                        args.remove_prefix(3 + length);
+                        return true;
+                }
+        }
+
+        out += "<arg inválido>";
+        args = std::string_view();
+        return true;
+}
+
+} // namespace
+
+void appendLogFileHeader(std::string& out) {
+        out.append(LOG_FILE_MAGIC, sizeof(LOG_FILE_MAGIC));
+        out.push_back(static_cast<char>(LOG_FILE_VERSION));
+        out.append(3, '\0');
+}
+
+uint8_t logFileVersion(std::string_view data) {
+        if (data.size() < LOG_FILE_HEADER_SIZE || std::memcmp(data.data(), LOG_FILE_MAGIC, sizeof(LOG_FILE_MAGIC)) != 0) {
+                return 0;
+        }
+        uint8_t version = static_cast<uint8_t>(data[4]);
+        return version >= 1 && version <= LOG_FILE_VERSION ? version : 0;
+}
+
+void appendLogRecord(std::string& out, const LogEntry& entry) {
+        appendRaw<uint16_t>(out, static_cast<uint16_t>(LOG_RECORD_HEADER_SIZE + entry.args.size()));
+        appendRaw<uint16_t>(out, entry.event);
+        appendRaw<uint8_t>(out, static_cast<uint8_t>(entry.level));
+        appendRaw<uint8_t>(out, entry.argCount);
+        appendRaw<uint16_t>(out, 0);
+        appendRaw<int64_t>(out, entry.timestampNs);
+        appendRaw<uint64_t>(out, entry.threadId);
+        out.append(entry.args);
+}
+
+RecordStatus readLogRecord(std::string_view data, LogEntry& entry, size_t& consumed, uint8_t version) {
+        if (data.size() < LOG_RECORD_HEADER_SIZE) {
+                return RecordStatus::Incomplete;
+        }
+
+        size_t length = readRaw<uint16_t>(data.data());
+        if (length < LOG_RECORD_HEADER_SIZE) {
+                return RecordStatus::Invalid;
+        }
+        if (data.size() < length) {
+                return RecordStatus::Incomplete;
+        }
+
+        entry.event = readRaw<uint16_t>(data.data() + 2);
+        entry.level = version >= 2 ? static_cast<LogLevel>(readRaw<uint8_t>(data.data() + 4)) : LogLevel::Info;
+        entry.argCount = readRaw<uint8_t>(data.data() + 5);
+        entry.timestampNs = readRaw<int64_t>(data.data() + 8);
+        entry.threadId = readRaw<uint64_t>(data.data() + 16);
+        entry.args.assign(data.data() + LOG_RECORD_HEADER_SIZE, length - LOG_RECORD_HEADER_SIZE);
+
+        consumed = length;
+        return RecordStatus::Complete;
+}
+
+const char* logLevelName(LogLevel level) {
+        switch (level) {
+        case LogLevel::Debug:
+                return "DEBUG";
+        case LogLevel::Info:
+                return "INFO";
+        case LogLevel::Warn:
+                return "WARN";
+        case LogLevel::Error:
+                return "ERRO";
+        }
+        return "?";
+}
+
+bool parseLogLevel(std::string_view text, LogLevel& level) {
+        if (text == "debug") {
+                level = LogLevel::Debug;
+        } else if (text == "info") {
+                level = LogLevel::Info;
+        } else if (text == "warn") {
+                level = LogLevel::Warn;
+        } else if (text == "error") {
+                level = LogLevel::Error;
+        } else {
+                return false;
+        }
+        return true;
+}
+
+void LogFormatter::format(const LogEntry& entry, std::string& out) {
+        time_t second = static_cast<time_t>(entry.timestampNs / 1000000000);
+        if (second != lastSecond) {
+                std::tm tm;
+                localtime_r(&second, &tm);
+
+                char buffer[32];
+                size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+                lastStamp.assign(buffer, length);
+                lastSecond = second;
+        }
+
+        out.append(lastStamp).append(" [").append(logLevelName(entry.level)).append("] [Thread ").append(std::to_string(entry.threadId)).append("] ");
+
+        std::string_view args(entry.args);
+        const char* format = logEventFormat(entry.event);
+        if (format == nullptr) {
+                out += "evento #" + std::to_string(entry.event);
+        } else {
+                for (const char* p = format; *p != '\0'; ++p) {
+                        if (p[0] == '{' && p[1] == '}') {
+                                appendNextArg(args, out);
+                                ++p;
+                        } else {
+                                out.push_back(*p);
+                        }
+                }
+        }
+
+        // Argumentos excedentes (ou de eventos desconhecidos) vão no fim
+        std::string extra;
+        while (appendNextArg(args, extra)) {
+                out.push_back(' ');
+                out += extra;
+                extra.clear();
+        }
+
+        out.push_back('\n');
+}
@@ -0,0 +1,185 @@
+#include "../lib/memory_pool.h"
+#include <algorithm>
+
+// Estoque por thread: até CACHE_BYTES por classe (entre 2 e MAX_CACHED blocos)
+static constexpr size_t CACHE_BYTES = 256 * 1024;
+static constexpr size_t MAX_CACHED = 32;
+// Limite do depósito global por classe, em bytes
+static constexpr size_t DEPOT_BYTES = 8 * 1024 * 1024;
+// Pedidos contados localmente antes de publicar no contador global
+static constexpr uint64_t PUBLISH_EVERY = 16;
+
+static size_t cacheLimit(size_t index) {
+        return std::clamp<size_t>(CACHE_BYTES / BufferPool::classSize(index), 2, MAX_CACHED);
+}
+
+static size_t depotLimit(size_t index) {
+        return std::max<size_t>(DEPOT_BYTES / BufferPool::classSize(index), 16);
+}
+
+struct BufferPoolThreadCache {
+        std::array<std::array<void*, MAX_CACHED>, BufferPool::CLASS_COUNT> blocks{};
+        std::array<size_t, BufferPool::CLASS_COUNT> counts{};
+        uint64_t unpublished = 0;
+        // Falso após o destrutor: objetos estáticos destruídos depois da
+        // thread_local (ex.: no fim do main) vão direto ao heap
+        bool active = true;
+
+        // Fim da thread: o estoque volta ao depósito para as demais
+        ~BufferPoolThreadCache() {
+                active = false;
+                BufferPool& pool = BufferPool::instance();
+                for (size_t index = 0; index < BufferPool::CLASS_COUNT; ++index) {
+                        spill(pool, index, counts[index]);
+                }
+                pool.requests.fetch_add(unpublished, std::memory_order_relaxed);
+        }
+
+        // Pega até metade do estoque no depósito; false se ele estiver vazio
+        bool refill(BufferPool& pool, size_t index) {
+                BufferPool::Depot& depot = pool.depots[index];
+                std::lock_guard<std::mutex> lock(depot.mutex);
+
+                size_t take = std::min(depot.blocks.size(), std::max<size_t>(cacheLimit(index) / 2, 1));
+                for (size_t i = 0; i < take; ++i) {
+                        blocks[index][counts[index]++] = depot.blocks.back();
+                        depot.blocks.pop_back();
+                }
+                pool.depotBytes.fetch_sub(take * BufferPool::classSize(index), std::memory_order_relaxed);
+                return take > 0;
+        }
+
+        // Devolve os 'amount' blocos do topo; o que passar do limite do depósito volta ao heap
+        void spill(BufferPool& pool, size_t index, size_t amount) {
+                BufferPool::Depot& depot = pool.depots[index];
+                std::lock_guard<std::mutex> lock(depot.mutex);
+
+                size_t kept = 0;
+                for (size_t i = 0; i < amount; ++i) {
+                        void* block = blocks[index][--counts[index]];
+                        if (depot.blocks.size() < depotLimit(index)) {
+                                depot.blocks.push_back(block);
+                                kept++;
+                        } else {
+                                ::operator delete(block);
+                        }
+                }
+                pool.depotBytes.fetch_add(kept * BufferPool::classSize(index), std::memory_order_relaxed);
+        }
+};
+
+static thread_local BufferPoolThreadCache threadCache;
+
+BufferPool& BufferPool::instance() {
+        static BufferPool* pool = new BufferPool();
+        return *pool;
+}
+
+size_t BufferPool::classIndex(size_t size) {
+        if (size <= MIN_CLASS_SIZE) {
+                return 0;
+        }
+        if (size > MAX_CLASS_SIZE) {
+                return CLASS_COUNT;
+        }
+        // Menor potência de dois >= size, relativa a MIN_CLASS_SIZE (64 = 2^6)
+        return static_cast<size_t>(64 - __builtin_clzll(size - 1)) - 6;
+}
+
+void* BufferPool::allocate(size_t size) {
+        size_t index = classIndex(size);
+        if (index == CLASS_COUNT) {
+                misses.fetch_add(1, std::memory_order_relaxed);
+                requests.fetch_add(1, std::memory_order_relaxed);
+                return ::operator new(size);
+        }
+
+        BufferPoolThreadCache& cache = threadCache;
+        if (!cache.active) {
+                return ::operator new(classSize(index));
+        }
+        if (++cache.unpublished == PUBLISH_EVERY) {
+                requests.fetch_add(PUBLISH_EVERY, std::memory_order_relaxed);
+                cache.unpublished = 0;
+        }
+
+        if (cache.counts[index] > 0 || cache.refill(*this, index)) {
+                return cache.blocks[index][--cache.counts[index]];
+        }
+
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(classSize(index));
+}
+
+void BufferPool::release(void* block, size_t size) {
+        if (!block) {
+                return;
+        }
+
+        size_t index = classIndex(size);
+        if (index == CLASS_COUNT) {
+                ::operator delete(block);
+                return;
+        }
+
+        BufferPoolThreadCache& cache = threadCache;
+        if (!cache.active) {
+                ::operator delete(block);
+                return;
+        }
+        if (cache.counts[index] == cacheLimit(index)) {
+                cache.spill(*this, index, cache.counts[index] / 2);
+        }
+        cache.blocks[index][cache.counts[index]++] = block;
+}
+
+BufferPool::Stats BufferPool::stats() const {
+        return {requests.load(std::memory_order_relaxed), misses.load(std::memory_order_relaxed),
+                depotBytes.load(std::memory_order_relaxed)};
+}
+
+static std::atomic<uint64_t> slabRequests{0};
+static std::atomic<uint64_t> slabMisses{0};
+
+// Slots múltiplos de 16 bytes mantêm o alinhamento de max_align_t
+SlabArena::SlabArena(size_t objectSize)
+    : slotSize((std::max(objectSize, sizeof(FreeSlot)) + alignof(std::max_align_t) - 1) &
+               ~(alignof(std::max_align_t) - 1)) {
+}
+
+void* SlabArena::allocate() {
+        slabRequests.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (freeList) {
+                FreeSlot* slot = freeList;
+                freeList = slot->next;
+                return slot;
+        }
+
+        slabMisses.fetch_add(1, std::memory_order_relaxed);
+        if (carveNext == nullptr || carveNext + slotSize > carveEnd) {
+                size_t bytes = std::max(SLAB_BYTES, slotSize);
+                carveNext = static_cast<char*>(::operator new(bytes));
+                carveEnd = carveNext + bytes;
+        }
+
+        void* slot = carveNext;
+        carveNext += slotSize;
+        return slot;
+}
+
+void SlabArena::release(void* slot) {
+        std::lock_guard<std::mutex> lock(mutex);
+        FreeSlot* free = static_cast<FreeSlot*>(slot);
+        free->next = freeList;
+        freeList = free;
+}
+
+uint64_t SlabArena::totalRequests() {
+        return slabRequests.load(std::memory_order_relaxed);
+}
+
+uint64_t SlabArena::totalMisses() {
+        return slabMisses.load(std::memory_order_relaxed);
+}
@@ -1,49 +1,284 @@
 #include "../lib/message_history.h"
-#include <iomanip>
-#include <sstream>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <ctime>
 
 MessageHistory::MessageHistory(size_t max) : maxSize(max) {
 }
 
+// Linha sem o '\n' final
+static std::string_view messageLine(const HistoryEntry& entry) {
+        std::string_view line = entry.message->view();
+        if (!line.empty() && line.back() == '\n') {
+                line.remove_suffix(1);
+        }
+        return line;
+}
+
+// O que o índice de busca vê: a linha sem o prefixo "Cliente N: " que o
+// broadcast acrescenta. Indexado, o prefixo faria "cliente" e os ids de
+// remetente casarem com todas as mensagens
+static std::string_view searchableText(std::string_view line) {
+        static constexpr std::string_view PREFIX = "Cliente ";
+        if (!line.empty() && line.back() == '\n') {
+                line.remove_suffix(1);
+        }
+        if (line.substr(0, PREFIX.size()) != PREFIX) {
+                return line;
+        }
+
+        size_t end = PREFIX.size();
+        while (end < line.size() && line[end] >= '0' && line[end] <= '9') {
+                end++;
+        }
+        if (end == PREFIX.size() || line.substr(end, 2) != ": ") {
+                return line;
+        }
+        return line.substr(end + 2);
+}
+
+// Deve ser chamado com historyMutex travado
+void MessageHistory::push(HistoryEntry entry, const std::vector<uint64_t>& keys) {
+        index.add(entry.sequence, keys);
+        messages.push_back(std::move(entry));
+
+        // Limitar tamanho do histórico
+        if (messages.size() > maxSize) {
+                index.remove(messages.front().sequence, searchableText(messageLine(messages.front())));
+                messages.pop_front();
+        }
+}
+
 void MessageHistory::addMessage(const std::string& msg, int senderSocket) {
+        addMessage(SharedBuffer::build(msg.size() + 1,
+                                       [&](char* out) {
+                                               std::memcpy(out, msg.data(), msg.size());
+                                               out[msg.size()] = '\n';
+                                       }),
+                   senderSocket);
+}
+
+uint64_t MessageHistory::addMessage(SharedBuffer framed, int senderSocket) {
+        // Tokeniza antes da trava: sob ela só as listas do índice são atualizadas
+        thread_local std::vector<uint64_t> keys;
+        SearchIndex::tokenize(searchableText(framed->view()), keys);
+
         std::lock_guard<std::mutex> lock(historyMutex);
 
+        uint64_t sequence = nextSequence++;
+
         HistoryEntry entry;
-        entry.message = msg;
+        entry.sequence = sequence;
+        entry.message = std::move(framed);
         entry.timestamp = std::chrono::system_clock::now();
         entry.senderSocket = senderSocket;
 
-        messages.push_back(entry);
+        entry.rendered = render(entry);
 
-        // Limitar tamanho do histórico
-        if (messages.size() > maxSize) {
-                messages.pop_front();
+        if (store) {
+                int64_t timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        entry.timestamp.time_since_epoch()).count();
+                store->append(entry.sequence, timestampNs, entry.message->view());
         }
+
+        push(std::move(entry), keys);
+        recentBlock.reset();
+        return sequence;
 }
 
-std::vector<std::string> MessageHistory::getRecentMessages(size_t count) const {
+size_t MessageHistory::attachStore(std::shared_ptr<HistoryStore> durable) {
         std::lock_guard<std::mutex> lock(historyMutex);
 
+        size_t recovered = durable->recover(maxSize, [&](const StoredMessage& stored) {
+                HistoryEntry entry;
+                entry.sequence = stored.sequence;
+                entry.message = makeSharedBuffer(stored.line);
+                entry.timestamp = std::chrono::system_clock::time_point(
+                        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                                std::chrono::nanoseconds(stored.timestampNs)));
+                entry.senderSocket = -1;
+                entry.rendered = render(entry);
+
+                // Um log com buracos (registros perdidos) recomeça a contagem contígua
+                if (!messages.empty() && entry.sequence != nextSequence) {
+                        messages.clear();
+                        index.clear();
+                }
+                nextSequence = entry.sequence + 1;
+
+                SearchIndex::tokenize(searchableText(messageLine(entry)), recoveredKeys);
+                push(std::move(entry), recoveredKeys);
+        });
+
+        store = std::move(durable);
+        recentBlock.reset();
+        return recovered;
+}
+
+// Deve ser chamado com historyMutex travado
+const char* MessageHistory::formatTimestamp(std::chrono::system_clock::time_point timestamp) {
+        time_t second = std::chrono::system_clock::to_time_t(timestamp);
+        if (second != lastStampSecond) {
+                std::tm tm;
+                localtime_r(&second, &tm);
+
+                char buffer[16];
+                std::strftime(buffer, sizeof(buffer), "%H:%M:%S", &tm);
+                std::memcpy(lastStamp, buffer, sizeof(lastStamp));
+                lastStampSecond = second;
+        }
+        return lastStamp;
+}
+
+// "[HH:MM:SS] " + linha, num bloco do pool; leituras e o bloco de entrada só copiam.
+// Deve ser chamado com historyMutex travado
+SharedBuffer MessageHistory::render(const HistoryEntry& entry) {
+        static constexpr size_t STAMP_BYTES = sizeof(lastStamp);
+        const char* stamp = formatTimestamp(entry.timestamp);
+        std::string_view line = messageLine(entry);
+        return SharedBuffer::build(STAMP_BYTES + 3 + line.size(), [&](char* out) {
+                *out++ = '[';
+                out = std::copy(stamp, stamp + STAMP_BYTES, out);
+                *out++ = ']';
+                *out++ = ' ';
+                std::copy(line.begin(), line.end(), out);
+        });
+}
+
+// Deve ser chamado com historyMutex travado
+std::vector<std::string> MessageHistory::renderedRange(size_t count) const {
         std::vector<std::string> result;
 
         size_t start = messages.size() > count ? messages.size() - count : 0;
+        result.reserve(messages.size() - start);
 
         for (size_t i = start; i < messages.size(); ++i) {
-                // Formatar: [HH:MM:SS] Cliente X: mensagem
-                auto time = std::chrono::system_clock::to_time_t(messages[i].timestamp);
-                std::tm tm = *std::localtime(&time);
+                result.emplace_back(messages[i].rendered->view());
+        }
+
+        return result;
+}
 
-                std::ostringstream oss;
-                oss << "[" << std::put_time(&tm, "%H:%M:%S") << "] " << messages[i].message;
+std::vector<std::string> MessageHistory::getRecentMessages(size_t count) const {
+        std::lock_guard<std::mutex> lock(historyMutex);
+        return renderedRange(count);
+}
 
-                result.push_back(oss.str());
+std::vector<std::string> MessageHistory::getAllMessages() const {
+        std::lock_guard<std::mutex> lock(historyMutex);
+        return renderedRange(messages.size());
+}
+
+// Deve ser chamado com historyMutex travado
+std::vector<HistoryLine> MessageHistory::linesFrom(size_t start) const {
+        std::vector<HistoryLine> result;
+        result.reserve(messages.size() - std::min(start, messages.size()));
+
+        for (size_t i = start; i < messages.size(); ++i) {
+                result.push_back(HistoryLine{messages[i].sequence, std::string(messages[i].rendered->view())});
         }
 
         return result;
 }
 
-std::vector<std::string> MessageHistory::getAllMessages() const {
-        return getRecentMessages(messages.size());
+std::vector<HistoryLine> MessageHistory::getRecentLines(size_t count) const {
+        std::lock_guard<std::mutex> lock(historyMutex);
+        return linesFrom(messages.size() > count ? messages.size() - count : 0);
+}
+
+HistorySlice MessageHistory::since(uint64_t after) const {
+        std::lock_guard<std::mutex> lock(historyMutex);
+
+        HistorySlice slice;
+        slice.last = nextSequence - 1;
+        if (messages.empty()) {
+                return slice;
+        }
+
+        slice.firstAvailable = messages.front().sequence;
+        if (after >= slice.last) {
+                return slice;
+        }
+
+        // Sequências contíguas: a posição no anel sai direto da diferença
+        size_t start = after < slice.firstAvailable ? 0 : static_cast<size_t>(after + 1 - slice.firstAvailable);
+        slice.lines = linesFrom(start);
+        return slice;
+}
+
+bool MessageHistory::search(std::string_view query, size_t limit, std::vector<HistoryLine>& lines) const {
+        std::lock_guard<std::mutex> lock(historyMutex);
+
+        lines.clear();
+        std::vector<uint64_t> matches;
+        if (!index.search(query, limit, matches)) {
+                return false;
+        }
+
+        // Resultados vêm do mais novo para o mais antigo; a posição no anel sai da sequência
+        lines.reserve(matches.size());
+        uint64_t first = messages.empty() ? 0 : messages.front().sequence;
+        for (auto it = matches.rbegin(); it != matches.rend(); ++it) {
+                const HistoryEntry& entry = messages[static_cast<size_t>(*it - first)];
+                lines.push_back(HistoryLine{entry.sequence, std::string(entry.rendered->view())});
+        }
+        return true;
+}
+
+uint64_t MessageHistory::lastSequence() const {
+        std::lock_guard<std::mutex> lock(historyMutex);
+        return nextSequence - 1;
+}
+
+SharedBuffer MessageHistory::getRecentBlock(size_t count) const {
+        std::lock_guard<std::mutex> lock(historyMutex);
+
+        if (recentBlock && recentBlockCount == count) {
+                return recentBlock;
+        }
+
+        static constexpr std::string_view EMPTY =
+                "=== Bem-vindo ao chat! Seja o primeiro a enviar uma mensagem. ===\n";
+        static constexpr std::string_view HEADER_PREFIX = "=== Últimas ";
+        static constexpr std::string_view HEADER_MIDDLE = " mensagens (até #";
+        static constexpr std::string_view HEADER_SUFFIX = ") ===\n";
+        static constexpr std::string_view FOOTER = "===========================\n";
+
+        if (messages.empty()) {
+                recentBlock = makeSharedBuffer(EMPTY);
+        } else {
+                size_t start = messages.size() > count ? messages.size() - count : 0;
+
+                char digits[24];
+                char* digitsEnd = std::to_chars(digits, digits + sizeof(digits), messages.size() - start).ptr;
+                char last[24];
+                char* lastEnd = std::to_chars(last, last + sizeof(last), nextSequence - 1).ptr;
+
+                // Mede antes para escrever tudo direto no bloco final
+                size_t total = HEADER_PREFIX.size() + (digitsEnd - digits) + HEADER_MIDDLE.size() + (lastEnd - last) +
+                               HEADER_SUFFIX.size() + FOOTER.size();
+                for (size_t i = start; i < messages.size(); ++i) {
+                        total += messages[i].rendered->size() + 1;
+                }
+
+                recentBlock = SharedBuffer::build(total, [&](char* out) {
+                        out = std::copy(HEADER_PREFIX.begin(), HEADER_PREFIX.end(), out);
+                        out = std::copy(digits, digitsEnd, out);
+                        out = std::copy(HEADER_MIDDLE.begin(), HEADER_MIDDLE.end(), out);
+                        out = std::copy(last, lastEnd, out);
+                        out = std::copy(HEADER_SUFFIX.begin(), HEADER_SUFFIX.end(), out);
+                        for (size_t i = start; i < messages.size(); ++i) {
+                                std::string_view line = messages[i].rendered->view();
+                                out = std::copy(line.begin(), line.end(), out);
+                                *out++ = '\n';
+                        }
+                        std::copy(FOOTER.begin(), FOOTER.end(), out);
+                });
+        }
+
+        recentBlockCount = count;
+        return recentBlock;
 }
 
 size_t MessageHistory::size() const {
@@ -54,4 +289,6 @@ size_t MessageHistory::size() const {
 void MessageHistory::clear() {
         std::lock_guard<std::mutex> lock(historyMutex);
         messages.clear();
+        index.clear();
+        recentBlock.reset();
 }
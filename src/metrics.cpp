@@ -0,0 +1,144 @@
+#include "../lib/metrics.h"
+#include <cmath>
+
+uint64_t Counter::value() const {
+        uint64_t sum = 0;
+        for (const auto& stripe : stripes) {
+                sum += stripe.value.load(std::memory_order_relaxed);
+        }
+        return sum;
+}
+
+// Cada thread recebe uma faixa fixa na primeira contagem (round-robin)
+size_t Counter::stripeIndex() {
+        static std::atomic<size_t> nextStripe{0};
+        static thread_local const size_t index = nextStripe.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+        return index;
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+                return static_cast<size_t>(value);
+        }
+        unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(value));
+        unsigned shift = msb - SUB_BITS;
+        return (shift + 1) * SUB_BUCKETS + static_cast<size_t>((value >> shift) - SUB_BUCKETS);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+        if (index < SUB_BUCKETS) {
+                return index;
+        }
+        size_t group = index / SUB_BUCKETS;
+        uint64_t sub = index % SUB_BUCKETS;
+        uint64_t width = uint64_t(1) << (group - 1);
+        return (SUB_BUCKETS + sub) * width + (width - 1);
+}
+
+void LatencyHistogram::record(uint64_t value) {
+        buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t seen = maximum.load(std::memory_order_relaxed);
+        while (value > seen && !maximum.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+        }
+}
+
+uint64_t LatencyHistogram::count() const {
+        uint64_t n = 0;
+        for (const auto& bucket : buckets) {
+                n += bucket.load(std::memory_order_relaxed);
+        }
+        return n;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+        uint64_t n = count();
+        if (n == 0) {
+                return 0;
+        }
+
+        uint64_t target = static_cast<uint64_t>(std::ceil(p * static_cast<double>(n)));
+        if (target == 0) {
+                target = 1;
+        }
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+                seen += buckets[i].load(std::memory_order_relaxed);
+                if (seen >= target) {
+                        uint64_t bound = bucketUpperBound(i);
+                        uint64_t highest = max();
+                        return bound < highest ? bound : highest;
+                }
+        }
+        return max();
+}
+
+MetricsRegistry::Entry& MetricsRegistry::addEntry(const std::string& name, const std::string& help, Kind kind) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        entries.emplace_back();
+        Entry& entry = entries.back();
+        entry.name = name;
+        entry.help = help;
+        entry.kind = kind;
+        return entry;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help) {
+        Entry& entry = addEntry(name, help, Kind::Counter);
+        entry.counter = std::make_unique<Counter>();
+        return *entry.counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help) {
+        Entry& entry = addEntry(name, help, Kind::Gauge);
+        entry.gauge = std::make_unique<Gauge>();
+        return *entry.gauge;
+}
+
+LatencyHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& help) {
+        Entry& entry = addEntry(name, help, Kind::Histogram);
+        entry.histogram = std::make_unique<LatencyHistogram>();
+        return *entry.histogram;
+}
+
+void MetricsRegistry::function(const std::string& name, const std::string& help, Kind kind, std::function<int64_t()> read) {
+        Entry& entry = addEntry(name, help, kind);
+        entry.read = std::move(read);
+}
+
+std::string MetricsRegistry::renderText() const {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        std::string out;
+
+        for (const auto& entry : entries) {
+                out += "# HELP " + entry.name + " " + entry.help + "\n";
+
+                if (entry.histogram) {
+                        const LatencyHistogram& h = *entry.histogram;
+                        out += "# TYPE " + entry.name + " summary\n";
+                        for (const char* q : {"0.5", "0.9", "0.99", "0.999"}) {
+                                out += entry.name + "{quantile=\"" + q + "\"} " +
+                                       std::to_string(h.percentile(std::stod(q))) + "\n";
+                        }
+                        out += entry.name + "_sum " + std::to_string(h.sum()) + "\n";
+                        out += entry.name + "_count " + std::to_string(h.count()) + "\n";
+                        out += entry.name + "_max " + std::to_string(h.max()) + "\n";
+                        continue;
+                }
+
+                out += "# TYPE " + entry.name + (entry.kind == Kind::Counter ? " counter\n" : " gauge\n");
+                out += entry.name + " ";
+                if (entry.read) {
+                        out += std::to_string(entry.read());
+                } else if (entry.counter) {
+                        out += std::to_string(entry.counter->value());
+                } else {
+                        out += std::to_string(entry.gauge->value());
+                }
+                out += "\n";
+        }
+
+        return out;
+}
@@ -0,0 +1,126 @@
+#include "../lib/outbound_queue.h"
+#include <algorithm>
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+// Máximo de mensagens agrupadas em um único sendmsg()
+static constexpr size_t MAX_IOV_PER_FLUSH = 64;
+
+// Liga TCP_CORK enquanto existir; o destrutor solta o que ficou retido
+class CorkGuard {
+public:
+        CorkGuard(int fd, bool enable) : fd(fd), active(enable && setCork(fd, 1)) {
+        }
+
+        ~CorkGuard() {
+                if (active) {
+                        setCork(fd, 0);
+                }
+        }
+
+private:
+        static bool setCork(int fd, int value) {
+                return setsockopt(fd, IPPROTO_TCP, TCP_CORK, &value, sizeof(value)) == 0;
+        }
+
+        int fd;
+        bool active;
+};
+
+OutboundQueue::OutboundQueue(size_t max, SlowConsumerPolicy p) : maxMessages(max ? max : 1), policy(p) {
+}
+
+OutboundQueue::PushResult OutboundQueue::push(SharedBuffer data) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+
+        if (pending.size() < maxMessages) {
+                queuedBytes += data->size();
+                pending.push_back(std::move(data));
+                return PushResult::Queued;
+        }
+
+        if (policy == SlowConsumerPolicy::Disconnect) {
+                return PushResult::Overflow;
+        }
+
+        // A mensagem em envio parcial não pode ser descartada sem quebrar o framing
+        size_t victim = headOffset > 0 ? 1 : 0;
+        if (policy == SlowConsumerPolicy::DropNew || victim >= pending.size()) {
+                return PushResult::DroppedNew;
+        }
+
+        queuedBytes -= pending[victim]->size();
+        pending.erase(victim);
+        queuedBytes += data->size();
+        pending.push_back(std::move(data));
+        return PushResult::DroppedOldest;
+}
+
+OutboundQueue::FlushResult OutboundQueue::flush(int fd, bool cork) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+
+        // Com um único sendmsg() o kernel já recebe o lote inteiro; o cork só
+        // compensa quando a descarga precisa de várias chamadas
+        CorkGuard corked(fd, cork && pending.size() > MAX_IOV_PER_FLUSH);
+
+        iovec iov[MAX_IOV_PER_FLUSH];
+
+        while (!pending.empty()) {
+                size_t count = std::min(pending.size(), MAX_IOV_PER_FLUSH);
+                for (size_t i = 0; i < count; ++i) {
+                        size_t skip = (i == 0) ? headOffset : 0;
+                        iov[i].iov_base = const_cast<char*>(pending[i]->data() + skip);
+                        iov[i].iov_len = pending[i]->size() - skip;
+                }
+
+                msghdr msg{};
+                msg.msg_iov = iov;
+                msg.msg_iovlen = count;
+
+                ssize_t sent = sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+                if (sent < 0) {
+                        if (errno == EINTR) {
+                                continue;
+                        }
+                        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                                return FlushResult::WouldBlock;
+                        }
+                        return FlushResult::Error;
+                }
+
+                // Descarta as mensagens enviadas por completo
+                size_t remaining = static_cast<size_t>(sent);
+                while (remaining > 0) {
+                        size_t headLeft = pending.front()->size() - headOffset;
+                        if (remaining < headLeft) {
+                                headOffset += remaining;
+                                break;
+                        }
+                        remaining -= headLeft;
+                        queuedBytes -= pending.front()->size();
+                        pending.pop_front();
+                        headOffset = 0;
+                }
+        }
+
+        return FlushResult::Drained;
+}
+
+bool OutboundQueue::empty() const {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        return pending.empty();
+}
+
+size_t OutboundQueue::size() const {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        return pending.size();
+}
+
+size_t OutboundQueue::bytesPending() const {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        return queuedBytes - headOffset;
+}
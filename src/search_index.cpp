@@ -0,0 +1,178 @@
+#include "../lib/search_index.h"
+#include <algorithm>
+#include <array>
+
+// Nós vazios guardados para reuso
+static constexpr size_t MAX_SPARE_NODES = 1024;
+
+// Byte normalizado do token (ASCII em minúsculas), ou 0 para separadores
+static const std::array<unsigned char, 256> TOKEN_BYTES = [] {
+        std::array<unsigned char, 256> table{};
+        for (int c = 0; c < 256; ++c) {
+                if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80) {
+                        table[c] = static_cast<unsigned char>(c);
+                } else if (c >= 'A' && c <= 'Z') {
+                        table[c] = static_cast<unsigned char>(c - 'A' + 'a');
+                }
+        }
+        return table;
+}();
+
+static uint64_t mix(uint64_t value) {
+        value *= 0x9E3779B97F4A7C15ull;
+        return value ^ (value >> 32);
+}
+
+void SearchIndex::tokenize(std::string_view text, std::vector<uint64_t>& keys) {
+        keys.clear();
+
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+        const unsigned char* end = p + text.size();
+        while (p < end) {
+                if (!TOKEN_BYTES[*p]) {
+                        p++;
+                        continue;
+                }
+
+                // Hash dos primeiros MAX_TOKEN_BYTES, 8 bytes por multiplicação
+                // (o FNV byte a byte dominava o custo); o resto do token só é pulado
+                uint64_t hash = 0;
+                uint64_t word = 0;
+                size_t length = 0;
+                const unsigned char* limit = p + std::min<size_t>(MAX_TOKEN_BYTES, end - p);
+                unsigned char c;
+                for (; p < limit && (c = TOKEN_BYTES[*p]); ++p) {
+                        word = (word << 8) | c;
+                        if (++length % 8 == 0) {
+                                hash = mix(hash ^ word);
+                                word = 0;
+                        }
+                }
+                hash = mix(hash ^ word ^ (static_cast<uint64_t>(length) << 56));
+                while (p < end && TOKEN_BYTES[*p]) {
+                        p++;
+                }
+                keys.push_back(hash);
+        }
+
+        // Um token repetido na mesma mensagem entra uma vez só na lista
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+void SearchIndex::add(uint64_t sequence, const std::vector<uint64_t>& keys) {
+        for (uint64_t key : keys) {
+                auto it = postings.find(key);
+                if (it == postings.end()) {
+                        if (spareNodes.empty()) {
+                                it = postings.try_emplace(key).first;
+                        } else {
+                                auto node = std::move(spareNodes.back());
+                                spareNodes.pop_back();
+                                node.key() = key;
+                                it = postings.insert(std::move(node)).position;
+                        }
+                }
+                it->second.push_back(sequence);
+        }
+        totalPostings += keys.size();
+}
+
+void SearchIndex::remove(uint64_t sequence, std::string_view text) {
+        tokenize(text, scratch);
+        for (uint64_t key : scratch) {
+                auto it = postings.find(key);
+                // A mais antiga indexada está sempre na frente da lista
+                if (it == postings.end() || it->second.empty() || it->second.front() != sequence) {
+                        continue;
+                }
+                it->second.pop_front();
+                totalPostings--;
+                if (it->second.empty()) {
+                        if (spareNodes.size() < MAX_SPARE_NODES) {
+                                spareNodes.push_back(postings.extract(it));
+                        } else {
+                                postings.erase(it);
+                        }
+                }
+        }
+}
+
+// Posição do maior elemento <= value em list[0, end); end se não houver
+static size_t floorIndex(const RingBuffer<uint64_t>& list, size_t end, uint64_t value) {
+        size_t low = 0;
+        size_t high = end;
+        while (low < high) {
+                size_t middle = low + (high - low) / 2;
+                if (list[middle] <= value) {
+                        low = middle + 1;
+                } else {
+                        high = middle;
+                }
+        }
+        return low == 0 ? end : low - 1;
+}
+
+bool SearchIndex::search(std::string_view query, size_t limit, std::vector<uint64_t>& matches) const {
+        matches.clear();
+
+        std::vector<uint64_t> keys;
+        tokenize(query, keys);
+        if (keys.empty()) {
+                return false;
+        }
+
+        std::vector<const Postings*> lists;
+        lists.reserve(keys.size());
+        for (uint64_t key : keys) {
+                auto it = postings.find(key);
+                if (it == postings.end()) {
+                        return true; // um termo ausente: nenhuma mensagem tem todos
+                }
+                lists.push_back(&it->second);
+        }
+        // A lista mais curta primeiro: ela limita os saltos das demais
+        std::sort(lists.begin(), lists.end(), [](const Postings* a, const Postings* b) { return a->size() < b->size(); });
+
+        // Interseção do fim para o começo (leapfrog): cada lista salta por busca
+        // binária até o maior valor <= candidato; quando todas coincidem é um resultado
+        std::vector<size_t> ends;
+        ends.reserve(lists.size());
+        for (const Postings* list : lists) {
+                ends.push_back(list->size());
+        }
+
+        uint64_t candidate = lists[0]->empty() ? 0 : (*lists[0])[lists[0]->size() - 1];
+        while (matches.size() < limit) {
+                uint64_t lowest = candidate;
+                bool agreed = true;
+                for (size_t i = 0; i < lists.size(); ++i) {
+                        size_t index = floorIndex(*lists[i], ends[i], candidate);
+                        if (index == ends[i]) {
+                                return true;
+                        }
+                        ends[i] = index + 1;
+                        uint64_t value = (*lists[i])[index];
+                        if (value != candidate) {
+                                agreed = false;
+                                lowest = std::min(lowest, value);
+                        }
+                }
+
+                if (agreed) {
+                        matches.push_back(candidate);
+                        if (candidate == 0) {
+                                return true;
+                        }
+                        candidate--;
+                } else {
+                        candidate = lowest;
+                }
+        }
+        return true;
+}
+
+void SearchIndex::clear() {
+        postings.clear();
+        totalPostings = 0;
+}
@@ -1,13 +1,17 @@
+#include "../lib/line_framer.h"
 #include "../lib/socket_guard.h"
+#include "../lib/wire_protocol.h"
 #include <arpa/inet.h>
 #include <iostream>
 #include <memory>
 #include <mutex>
 #include <netinet/in.h>
 #include <string>
+#include <string_view>
 #include <sys/socket.h>
 #include <thread>
 #include <unistd.h>
+#include <algorithm>
 #include <csignal>
 
 // Mutex global para proteger std::cout
@@ -18,12 +22,13 @@ private:
         std::unique_ptr<SocketGuard> clientSocket;
         std::string serverIP;
         int serverPort;
+        bool binaryMode; // Protocolo binário (quadros) em vez de linhas de texto
         bool running;
         std::unique_ptr<std::thread> receiveThread;
 
 public:
-        TCPChatClient(const std::string& ip = "127.0.0.1", int port = 8080)
-            : serverIP(ip), serverPort(port), running(false) {
+        TCPChatClient(const std::string& ip = "127.0.0.1", int port = 8080, bool binary = false)
+            : serverIP(ip), serverPort(port), binaryMode(binary), running(false) {
         }
 
         ~TCPChatClient() {
@@ -67,6 +72,11 @@ public:
                         std::cout << "Conectado ao servidor " << serverIP << ":" << serverPort << std::endl;
                 }
 
+                // Negocia o protocolo binário antes de qualquer mensagem
+                if (binaryMode) {
+                        send(clientSocket->get(), BINARY_HELLO, BINARY_HELLO_SIZE, MSG_NOSIGNAL);
+                }
+
                 running = true;
 
                 // Criar thread com smart pointer
@@ -76,11 +86,12 @@ public:
         }
 
         void receiveMessages() {
-                std::string acc;
-                char buf[1024];
+                LineFramer framer;
+                const size_t chunkSize = 16 * 1024;
+                bool helloAcked = false;
 
                 while (running) {
-                        int n = recv(clientSocket->get(), buf, sizeof(buf), 0);
+                        int n = recv(clientSocket->get(), framer.prepareWrite(chunkSize), chunkSize, 0);
                         if (n <= 0) {
                                 {
                                         std::lock_guard<std::mutex> lock(coutMutex);
@@ -88,30 +99,83 @@ public:
                                 }
                                 running = false;
                                 kill(getpid(), SIGTERM);
+                                return;
                         }
 
-                        acc.append(buf, n);
+                        framer.commitWrite(n);
 
-                        size_t pos;
-                        while ((pos = acc.find('\n')) != std::string::npos) {
-                                std::string line = acc.substr(0, pos);
-                                acc.erase(0, pos + 1);
-
-                                if (!line.empty() && line.back() == '\r') {
-                                        line.pop_back();
+                        if (binaryMode) {
+                                if (!helloAcked) {
+                                        helloAcked = skipUntilHelloAck(framer);
+                                }
+                                if (helloAcked) {
+                                        receiveFrames(framer);
                                 }
+                                continue;
+                        }
 
+                        std::string_view line;
+                        while (framer.nextLine(line)) {
                                 if (!line.empty()) {
-                                        std::lock_guard<std::mutex> lock(coutMutex);
-                                        std::cout << "\r" << std::string(50, ' ') << "\r";
-                                        std::cout << line << std::endl;
-                                        std::cout << "> " << std::flush;
+                                        printLine(line);
+                                } else {
+                                        // Heartbeat do servidor: responder mantém a conexão ativa
+                                        sendMessage("");
                                 }
                         }
                 }
         }
 
+        // Descarta o texto de boas-vindas enviado antes da confirmação do protocolo
+        static bool skipUntilHelloAck(LineFramer& framer) {
+                std::string_view data = framer.pending();
+                size_t pos = data.find(std::string_view(BINARY_HELLO, BINARY_HELLO_SIZE));
+
+                if (pos == std::string_view::npos) {
+                        // Guarda um possível início parcial do preâmbulo
+                        size_t keep = std::min(data.size(), BINARY_HELLO_SIZE - 1);
+                        framer.consume(data.size() - keep);
+                        return false;
+                }
+
+                framer.consume(pos + BINARY_HELLO_SIZE);
+                return true;
+        }
+
+        void receiveFrames(LineFramer& framer) {
+                FrameHeader header;
+                std::string_view payload;
+                size_t consumed = 0;
+
+                while (decodeFrame(framer.pending(), header, payload, consumed) == DecodeStatus::Complete) {
+                        if (header.type == FrameType::Chat) {
+                                printLine("Cliente " + std::to_string(header.senderId) + ": " + std::string(payload));
+                        } else if (header.type == FrameType::Ping) {
+                                SharedBuffer pong = encodeFrame(FrameType::Ping, 0, 0, {});
+                                send(clientSocket->get(), pong->data(), pong->size(), 0);
+                        } else if (header.type == FrameType::Direct) {
+                                printLine("[privado] Cliente " + std::to_string(header.senderId) + ": " + std::string(payload));
+                        } else {
+                                printLine(payload);
+                        }
+                        framer.consume(consumed);
+                }
+        }
+
+        void printLine(std::string_view line) {
+                std::lock_guard<std::mutex> lock(coutMutex);
+                std::cout << "\r" << std::string(50, ' ') << "\r";
+                std::cout << line << std::endl;
+                std::cout << "> " << std::flush;
+        }
+
         void sendMessage(const std::string& message) {
+                if (binaryMode) {
+                        SharedBuffer frame = encodeFrame(FrameType::Chat, 0, 0, message);
+                        send(clientSocket->get(), frame->data(), frame->size(), 0);
+                        return;
+                }
+
                 std::string out = message;
                 if (out.empty() || out.back() != '\n') {
                         out.push_back('\n');
@@ -176,13 +240,22 @@ int main(int argc, char* argv[]) {
         try {
                 std::string serverIP = "127.0.0.1";
                 int serverPort = 8080;
+                bool binary = false;
+
+                // Uso: tcp_client [--binary] [IP] [PORTA]
+                int positional = 0;
+                for (int i = 1; i < argc; ++i) {
+                        std::string arg = argv[i];
+                        if (arg == "--binary") {
+                                binary = true;
+                        } else if (positional++ == 0) {
+                                serverIP = arg;
+                        } else {
+                                serverPort = std::stoi(arg);
+                        }
+                }
 
-                if (argc >= 2)
-                        serverIP = argv[1];
-                if (argc >= 3)
-                        serverPort = std::stoi(argv[2]);
-
-                TCPChatClient client(serverIP, serverPort);
+                TCPChatClient client(serverIP, serverPort, binary);
                 client.start();
 
         } catch (const std::exception& e) {
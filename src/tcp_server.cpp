@@ -1,46 +1,288 @@
+#include "../lib/chat_room.h"
+#include "../lib/client_registry.h"
+#include "../lib/coro_socket.h"
+#include "../lib/event_loop.h"
+#include "../lib/history_store.h"
 #include "../lib/libtslog.h"
-#include "../lib/message_history.h"
+#include "../lib/line_framer.h"
+#include "../lib/memory_pool.h"
+#include "../lib/metrics.h"
+#include "../lib/outbound_queue.h"
+#include "../lib/shared_buffer.h"
 #include "../lib/socket_guard.h"
+#include "../lib/wire_protocol.h"
+#include "../lib/work_stealing_pool.h"
 #include <algorithm>
 #include <arpa/inet.h>
 #include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cerrno>
+#include <chrono>
 #include <csignal>
+#include <cstdint>
+#include <iomanip>
 #include <iostream>
 #include <memory>
 #include <mutex>
 #include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
 #include <string>
+#include <string_view>
+#include <stdexcept>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
+#include <sys/timerfd.h>
 #include <thread>
 #include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+// Modelo de concorrência do servidor
+enum class ServerMode {
+        Threads, // 1 thread bloqueante por cliente (modelo original)
+        Epoll,   // 1 laço epoll edge-triggered com sockets não bloqueantes
+        Sharded, // N laços epoll, cada um com socket SO_REUSEPORT e clientes próprios
+        Pool,    // 1 laço epoll só para I/O; o processamento roda em um pool fixo de workers
+        Coro     // Como sharded, mas cada conexão é uma corrotina C++20 sobre o laço
+};
+
+struct ServerConfig {
+        int port = 8080;
+        int backlog = SOMAXCONN; // Fila de conexões pendentes no kernel (limitada por net.core.somaxconn)
+        ServerMode mode = ServerMode::Threads;
+        unsigned shards = 0; // Modos sharded e coro: 0 = um por núcleo
+        unsigned workers = 0; // Modo pool: 0 = um por núcleo
+        size_t queueLimit = 1024; // Mensagens pendentes por cliente
+        SlowConsumerPolicy slowPolicy = SlowConsumerPolicy::DropOldest;
+        LogLevel logLevel = LogLevel::Debug; // Debug = tudo o que foi compilado
+        int adminPort = 0; // Endpoint de métricas em 127.0.0.1 (0 = desligado)
+        unsigned batchWindowUs = 0; // Modos reator: janela de agrupamento de envios (0 = desligado)
+        size_t batchMaxBytes = 64 * 1024; // Bytes pendentes que forçam a descarga antes da janela
+        std::string historyDir; // Log durável do histórico (vazio = só em memória)
+        unsigned historySyncMs = 10; // Intervalo do group commit (um fdatasync por sala e intervalo)
+        size_t historySize = 100; // Mensagens guardadas (e indexadas para /search) por sala
+        size_t maxRooms = 1024;   // Salas simultâneas (cada uma com histórico e, com log durável, um fd)
+        unsigned idleTimeoutSec = 0; // Desconecta quem passa esse tempo sem enviar nada (0 = nunca)
+        unsigned heartbeatSec = 0;   // Ping para conexões quietas há esse tempo (0 = desligado)
+};
+
+// Espaço reservado no framer a cada recv(): várias linhas por syscall
+static constexpr size_t RECV_CHUNK_SIZE = 16 * 1024;
+
+// Protocolo do cliente, decidido pelo primeiro byte recebido
+enum class ClientProtocol {
+        Unknown, // nada recebido ainda (recebe como texto)
+        Text,    // linhas terminadas em '\n'
+        Binary   // quadros com prefixo de tamanho (wire_protocol.h)
+};
+
+// Mensagem de chat roteada. A linha de texto é codificada uma vez; o quadro
+// binário é criado sob demanda por quem encontrar o primeiro destinatário binário.
+struct ChatMessage {
+        uint64_t sequence = 0; // 0 nas mensagens privadas (não entram no histórico)
+        int senderId = 0;
+        bool direct = false;      // /msg: quadro Direct em vez de Chat
+        SharedBuffer text;        // "Cliente N: texto\n"
+        size_t payloadOffset = 0; // início do texto cru dentro de 'text'
+        std::chrono::steady_clock::time_point receivedAt; // base das métricas de latência
+
+        std::string_view payload() const {
+                return text->view().substr(payloadOffset, text->size() - payloadOffset - 1);
+        }
+};
+
+struct Shard;
+struct ClientInfo;
+
+using Room = ChatRoom<ClientInfo>;
+using RoomPtr = std::shared_ptr<Room>;
+
 // Estrutura para gerenciar informações do cliente
-struct ClientInfo {
+struct ClientInfo : std::enable_shared_from_this<ClientInfo> {
         int socket;
         int clientId;
+        // RAII: o socket só fecha quando a última referência (inclusive snapshots do registro) sai
+        SocketGuard guard;
         std::unique_ptr<std::thread> thread;
+        Shard* shard = nullptr; // Modos reator: shard dono do socket
+        OutboundQueue outbound; // Fila de saída limitada, drenada sem bloquear
+        std::atomic<bool> wantWrite{false}; // Kernel sem espaço: aguardando POLLOUT/EPOLLOUT
+        std::atomic<bool> closing{false};   // Desconexão já solicitada
+        LineFramer framer;                  // Bytes recebidos ainda não processados
+        std::atomic<ClientProtocol> protocol{ClientProtocol::Unknown};
+        RoomPtr room; // Sala atual (alterada só pela thread dona do cliente)
+        std::chrono::steady_clock::time_point acceptedAt; // base da latência de entrada
+        bool batchPending = false; // Na lista de descarga do shard (só a thread do shard acessa)
+        std::shared_ptr<Strand> strand; // Modo pool: eventos do cliente em ordem, um por vez
+        std::mutex flushMutex; // Serializa descarga e rearmação do epoll entre threads
+        AsyncSocket* async = nullptr; // Modo coro: socket aguardável no quadro da corrotina
+        // Ociosidade: instante (steady_clock, ns) do último byte recebido; workers do modo pool também escrevem
+        std::atomic<int64_t> lastActivityNs{0};
+        int64_t lastPingNs = 0; // Último heartbeat enviado (só quem verifica a conexão acessa)
+        TimerWheel::TimerId livenessTimer = 0; // Modos reator: verificação agendada na roda do shard
+
+        ClientInfo(int sock, int id, size_t queueLimit, SlowConsumerPolicy policy)
+            : socket(sock), clientId(id), guard(sock), outbound(queueLimit, policy) {
+        }
+};
+
+// Mensagem destinada aos assinantes de uma sala em outro shard,
+// ou só a 'recipient' (mensagem privada; 'room' fica nulo)
+struct RoomDelivery {
+        RoomPtr room;
+        ChatMessage chat;
+        std::shared_ptr<ClientInfo> recipient;
+};
+
+// Reator independente: socket de escuta, laço epoll e clientes próprios.
+// Só a thread do shard acessa 'clients'; as demais falam com ele pela inbox.
+struct Shard {
+        int index;
+        int listenSocket = -1;
+        int wakeFd;
+        EventLoop loop;
+        std::unordered_map<int, std::shared_ptr<ClientInfo>> clients;
+        std::atomic<size_t> clientCount{0};
+
+        // Mensagens já codificadas vindas de outros shards
+        std::mutex inboxMutex;
+        std::vector<RoomDelivery> inbox;
+        std::vector<std::shared_ptr<ClientInfo>> closeRequests; // Modo pool: fechamentos pedidos pelos workers
+        // Trocados com os de cima a cada drenagem, já vazios e com capacidade:
+        // em regime estável ninguém realoca os vetores
+        std::vector<RoomDelivery> inboxSpare;
+        std::vector<std::shared_ptr<ClientInfo>> closeSpare;
+
+        // Agrupamento de envios: clientes com fila a descarregar quando o timer disparar
+        int batchTimerFd;
+        std::vector<std::shared_ptr<ClientInfo>> batchDirty;
+        std::vector<std::shared_ptr<ClientInfo>> batchSpare;
+
+        AsyncSocket* acceptor = nullptr; // Modo coro: socket de escuta da corrotina de accept
+
+        explicit Shard(int i)
+            : index(i), wakeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+              batchTimerFd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) {
+        }
+
+        ~Shard() {
+                if (wakeFd >= 0) {
+                        close(wakeFd);
+                }
+                if (batchTimerFd >= 0) {
+                        close(batchTimerFd);
+                }
+        }
 
-        ClientInfo(int sock, int id) : socket(sock), clientId(id) {
+        void wake() {
+                uint64_t one = 1;
+                ssize_t ignored = write(wakeFd, &one, sizeof(one));
+                (void)ignored;
         }
 };
 
 class TCPChatServer {
 private:
-        int serverSocket;
+        int serverSocket = -1;
         int port;
+        int backlog;
+        ServerMode mode;
+        unsigned shardCount;
+        size_t queueLimit;
+        SlowConsumerPolicy slowPolicy;
+        BackpressureStats backpressure;
+
+        // Modos reator: troca até batchWindowUs de latência por menos syscalls e pacotes
+        unsigned batchWindowUs;
+        size_t batchMaxBytes;
+
+        // Ociosidade e heartbeat, em ns (0 = desligado)
+        int64_t idleTimeoutNs;
+        int64_t heartbeatNs;
         ThreadSafeLogger logger;
-        MessageHistory messageHistory;
 
-        // Usando shared_ptr para gerenciar clientes
-        std::vector<std::shared_ptr<ClientInfo>> clients;
-        std::mutex clientsMutex;
-        int nextClientId = 1;
+        // Métricas expostas no 'status' e no endpoint de administração
+        int adminPort;
+        MetricsRegistry metrics;
+        Counter& acceptsTotal;
+        Counter& disconnectsTotal;
+        Counter& messagesReceived;
+        Counter& bytesReceived;
+        Counter& deliveriesTotal;
+        Counter& directMessages;
+        Counter& idleDisconnects;
+        Counter& heartbeatsSent;
+        Counter& bytesQueued;
+        Counter& flushesTotal;
+        LatencyHistogram& fanoutLatency;
+        LatencyHistogram& crossShardLatency;
+        LatencyHistogram& acceptLatency;
+        LatencyHistogram& joinLatency;
+        LatencyHistogram& acceptBatch;
+        LatencyHistogram& searchLatency;
+
+        // Taxa de conexões mostrada no 'status' (só a thread do console acessa)
+        uint64_t statusAccepts = 0;
+        std::chrono::steady_clock::time_point statusTime = std::chrono::steady_clock::now();
+
+        // Log durável das salas; declarado antes de 'rooms' para ser destruído
+        // depois delas (o destrutor faz o último commit)
+        std::unique_ptr<HistoryJournal> journal;
+
+        // Salas por nome; cada uma com histórico e assinantes por shard
+        RoomDirectory<ClientInfo> rooms;
+        static constexpr const char* DEFAULT_ROOM = "geral";
+        // Resultados por /search (os mais recentes)
+        static constexpr size_t SEARCH_LIMIT = 20;
+
+        // Todos os clientes conectados, por id: busca O(1) e iteração sem trava
+        ClientRegistry<ClientInfo> registry;
+        std::atomic<int> nextClientId{1};
+
+        // Modos reator: criados antes do console e imutáveis depois
+        std::vector<std::unique_ptr<Shard>> shards;
+
+        // Modo pool: workers que processam os eventos dos clientes
+        std::unique_ptr<WorkStealingPool> pool;
 
         std::atomic<bool> running{true};
 
 public:
-        TCPChatServer(int p = 8080) : port(p), messageHistory(100) {
+        explicit TCPChatServer(const ServerConfig& config = ServerConfig())
+            : port(config.port), backlog(config.backlog), mode(config.mode), shardCount(resolveShardCount(config)),
+              queueLimit(config.queueLimit), slowPolicy(config.slowPolicy),
+              batchWindowUs(config.mode == ServerMode::Pool || config.mode == ServerMode::Threads ? 0 : config.batchWindowUs),
+              batchMaxBytes(config.batchMaxBytes), idleTimeoutNs(int64_t(config.idleTimeoutSec) * 1000000000),
+              heartbeatNs(int64_t(config.heartbeatSec) * 1000000000), adminPort(config.adminPort),
+              acceptsTotal(metrics.counter("chat_accepts_total", "Conexões aceitas")),
+              disconnectsTotal(metrics.counter("chat_disconnects_total", "Clientes desconectados")),
+              messagesReceived(metrics.counter("chat_messages_received_total", "Mensagens de chat recebidas")),
+              bytesReceived(metrics.counter("chat_bytes_received_total", "Bytes lidos dos clientes")),
+              deliveriesTotal(metrics.counter("chat_deliveries_total", "Mensagens entregues a destinatários (fan-out)")),
+              directMessages(metrics.counter("chat_direct_messages_total", "Mensagens privadas entregues (/msg)")),
+              idleDisconnects(metrics.counter("chat_idle_disconnects_total", "Clientes desconectados por ociosidade")),
+              heartbeatsSent(metrics.counter("chat_heartbeats_sent_total", "Pings enviados a conexões quietas")),
+              bytesQueued(metrics.counter("chat_bytes_queued_total", "Bytes enfileirados para envio")),
+              flushesTotal(metrics.counter("chat_flushes_total", "Descargas de filas de saída")),
+              fanoutLatency(metrics.histogram("chat_fanout_latency_ns", "Recepção até o fim do fan-out local, em ns")),
+              crossShardLatency(metrics.histogram("chat_cross_shard_latency_ns", "Recepção até a entrega em outro shard, em ns")),
+              acceptLatency(metrics.histogram("chat_accept_latency_ns", "Socket de escuta pronto até o accept da conexão, em ns")),
+              joinLatency(metrics.histogram("chat_join_latency_ns", "Accept até o histórico enfileirado, em ns")),
+              acceptBatch(metrics.histogram("chat_accepts_per_wakeup", "Conexões aceitas por despertar do socket de escuta")),
+              searchLatency(metrics.histogram("chat_search_latency_ns", "Consulta ao índice do histórico (/search), em ns")),
+              journal(config.historyDir.empty() ? nullptr
+                                                : std::make_unique<HistoryJournal>(
+                                                          config.historyDir, std::chrono::milliseconds(config.historySyncMs))),
+              rooms(shardCount, config.historySize, config.maxRooms,
+                    journal && journal->isOpen() ? journal.get() : nullptr) {
+                if (mode == ServerMode::Pool) {
+                        pool = std::make_unique<WorkStealingPool>(config.workers);
+                }
+                logger.setMinLevel(config.logLevel);
+                registerDerivedMetrics();
         }
 
         ~TCPChatServer() {
@@ -52,18 +294,18 @@ public:
                         return; // Já foi encerrado
                 }
 
-                logger.log("Servidor encerrando...");
+                logger.info(LogEvent::ServerStopping);
 
-                // Desconectar todos os clientes
-                {
-                        std::lock_guard<std::mutex> lock(clientsMutex);
-                        for (auto& client : clients) {
-                                if (client->socket >= 0) {
-                                        ::shutdown(client->socket, SHUT_RDWR);
-                                        close(client->socket);
-                                }
+                // Desconectar todos os clientes (modo threads); cada thread sai ao ver EOF
+                if (mode == ServerMode::Threads) {
+                        for (auto& client : registry.clear()) {
+                                ::shutdown(client->socket, SHUT_RDWR);
                         }
-                        clients.clear();
+                }
+
+                // Nos modos reator cada shard fecha os próprios clientes ao acordar
+                for (auto& shard : shards) {
+                        shard->wake();
                 }
 
                 // Fechar socket do servidor
@@ -73,7 +315,7 @@ public:
                         serverSocket = -1;
                 }
 
-                logger.log("Servidor encerrado");
+                logger.info(LogEvent::ServerStopped);
                         std::cout << "\n✅ Servidor encerrado" << std::endl;
         }
 
@@ -94,7 +336,7 @@ public:
 
                         if (!std::getline(std::cin, command) || std::cin.eof()) {
                                 // Sem stdin (modo background): sai só da thread de comandos
-                                logger.log("Entrada padrão indisponível - executando sem console");
+                                logger.info(LogEvent::ConsoleUnavailable);
                                 return; // não altera 'running'
                             }
 
@@ -103,18 +345,27 @@ public:
 
                         if (command.empty())
                                 continue;
-                        
+
                         if (command == "sair") {
                                 std::cout << "Encerrando servidor..." << std::endl;
                                 shutdown();
                                 break;
                         } else if (command == "status") {
-                                std::lock_guard<std::mutex> lock(clientsMutex);
-                                std::cout << "Clientes conectados: " << clients.size() << std::endl;
-                                std::cout << "Mensagens no histórico: " << messageHistory.size() << std::endl;
+                                printStatus();
+                        } else if (command == "metrics") {
+                                std::cout << metrics.renderText();
+                        } else if (command == "rooms") {
+                                for (const auto& room : rooms.list()) {
+                                        std::cout << "  " << room.first << ": " << room.second << " membro(s)" << std::endl;
+                                }
+                        } else if (command.rfind("search ", 0) == 0) {
+                                searchConsole(std::string_view(command).substr(7));
                         } else if (command == "help") {
                                 std::cout << "Comandos disponíveis:" << std::endl;
                                 std::cout << "  status   - Mostra número de clientes conectados" << std::endl;
+                                std::cout << "  rooms    - Lista as salas e seus membros" << std::endl;
+                                std::cout << "  metrics  - Todas as métricas no formato de scrape" << std::endl;
+                                std::cout << "  search <termos> - Busca no histórico de todas as salas" << std::endl;
                                 std::cout << "  sair - Encerra o servidor" << std::endl;
                                 std::cout << "  help     - Mostra esta mensagem" << std::endl;
                         } else if (!command.empty()) {
@@ -123,211 +374,1521 @@ public:
                 }
         }
 
+        // Console: mesma busca do /search, em todas as salas
+        void searchConsole(std::string_view query) {
+                std::vector<HistoryLine> lines;
+                size_t total = 0;
+                bool valid = true;
+                rooms.forEach([&](Room& room) {
+                        auto startedAt = std::chrono::steady_clock::now();
+                        valid = room.history().search(query, SEARCH_LIMIT, lines);
+                        searchLatency.record(elapsedNs(startedAt));
+                        for (const auto& line : lines) {
+                                std::cout << "  [" << room.getName() << "] #" << line.sequence << " " << line.text << std::endl;
+                        }
+                        total += lines.size();
+                });
+                if (!valid) {
+                        std::cout << "Uso: search <termos>" << std::endl;
+                        return;
+                }
+                std::cout << total << " resultado(s)" << std::endl;
+        }
+
+        // Cria a sala padrão e, com log durável, todas as salas que já têm
+        // histórico em disco (cada uma recarrega só os segmentos do fim)
+        void openRooms() {
+                if (journal && !journal->isOpen()) {
+                        logger.error(LogEvent::Error, "Falha ao abrir o diretório de histórico; histórico só em memória");
+                }
+
+                std::vector<std::string> names{DEFAULT_ROOM};
+                if (journal && journal->isOpen()) {
+                        for (const auto& name : journal->existingRooms()) {
+                                if (name != DEFAULT_ROOM && isValidRoomName(name)) {
+                                        names.push_back(name);
+                                }
+                        }
+                }
+
+                for (const auto& name : names) {
+                        auto startedAt = std::chrono::steady_clock::now();
+                        RoomPtr room = rooms.getOrCreate(name);
+                        if (!room) {
+                                logger.warn(LogEvent::RoomLimitReached, rooms.limit(), name);
+                                continue;
+                        }
+                        if (journal && journal->isOpen()) {
+                                logger.info(LogEvent::HistoryRecovered, name, room->history().size(),
+                                            elapsedNs(startedAt) / 1000);
+                        }
+                }
+        }
+
         void start() {
-                logger.initialize("logs/server.log");
-                logger.log("Servidor iniciando na porta " + std::to_string(port));
+                logger.initialize("logs/server.bin", LogOutput::Binary);
+                logger.info(LogEvent::ServerStarting, port);
+                openRooms();
+
+                // Nos modos sharded e coro todos os sockets de escuta compartilham a porta
+                serverSocket = openListenSocket(port, mode == ServerMode::Sharded || mode == ServerMode::Coro);
+                if (serverSocket < 0) {
+                        return;
+                }
+
+                logger.info(LogEvent::ServerListening, port);
+
+                if (mode != ServerMode::Threads && !createShards()) {
+                        return;
+                }
+
+                std::thread adminThread;
+                if (adminPort > 0) {
+                        int adminSocket = openListenSocket(adminPort, false, INADDR_LOOPBACK);
+                        if (adminSocket >= 0) {
+                                logger.info(LogEvent::AdminListening, adminPort);
+                                adminThread = std::thread(&TCPChatServer::runAdminEndpoint, this, adminSocket);
+                        }
+                }
+
+                std::thread commandThread(&TCPChatServer::commandLoop, this);
+                commandThread.detach();
 
+                if (mode == ServerMode::Threads) {
+                        runAcceptLoop();
+                } else {
+                        runShards();
+                }
+
+                logger.info(LogEvent::MainLoopStopped);
+
+                if (adminThread.joinable()) {
+                        adminThread.join();
+                }
+
+                if (commandThread.joinable()) {
+                        commandThread.join();
+                }
+        }
+
+private:
+        static unsigned resolveShardCount(const ServerConfig& config) {
+                if (config.mode != ServerMode::Sharded && config.mode != ServerMode::Coro) {
+                        return 1;
+                }
+                return config.shards ? config.shards : std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        // Métricas calculadas na leitura a partir de estado que já existe
+        void registerDerivedMetrics() {
+                using Kind = MetricsRegistry::Kind;
+
+                metrics.function("chat_clients_connected", "Clientes conectados", Kind::Gauge,
+                                 [this] { return static_cast<int64_t>(registry.size()); });
+                metrics.function("chat_outbound_queue_depth", "Mensagens pendentes nas filas de saída", Kind::Gauge, [this] {
+                        int64_t depth = 0;
+                        registry.forEach([&](const std::shared_ptr<ClientInfo>& client) {
+                                depth += static_cast<int64_t>(client->outbound.size());
+                        });
+                        return depth;
+                });
+                metrics.function("chat_shard_inbox_depth", "Entregas aguardando nas inboxes dos shards", Kind::Gauge, [this] {
+                        int64_t depth = 0;
+                        for (auto& shard : shards) {
+                                std::lock_guard<std::mutex> lock(shard->inboxMutex);
+                                depth += static_cast<int64_t>(shard->inbox.size());
+                        }
+                        return depth;
+                });
+                metrics.function("chat_dropped_oldest_total", "Mensagens antigas descartadas (fila cheia)", Kind::Counter,
+                                 [this] { return static_cast<int64_t>(backpressure.droppedOldest.load()); });
+                metrics.function("chat_dropped_new_total", "Mensagens novas descartadas (fila cheia)", Kind::Counter,
+                                 [this] { return static_cast<int64_t>(backpressure.droppedNew.load()); });
+                metrics.function("chat_slow_disconnects_total", "Clientes desconectados por fila cheia", Kind::Counter,
+                                 [this] { return static_cast<int64_t>(backpressure.disconnected.load()); });
+                metrics.function("chat_log_dropped_total", "Entradas de log descartadas", Kind::Counter,
+                                 [this] { return static_cast<int64_t>(logger.droppedCount()); });
+
+                metrics.function("chat_coroutine_frames", "Quadros de corrotina vivos", Kind::Gauge,
+                                 [] { return static_cast<int64_t>(coroutineFrameStats().liveFrames); });
+                metrics.function("chat_coroutine_frame_bytes", "Bytes em quadros de corrotina vivos", Kind::Gauge,
+                                 [] { return static_cast<int64_t>(coroutineFrameStats().liveBytes); });
+
+                if (journal && journal->isOpen()) {
+                        metrics.function("chat_history_appends_total", "Mensagens enviadas ao log durável", Kind::Counter,
+                                         [this] { return static_cast<int64_t>(journal->stats().appended); });
+                        metrics.function("chat_history_dropped_total", "Mensagens não gravadas (lote pendente cheio)",
+                                         Kind::Counter, [this] { return static_cast<int64_t>(journal->stats().dropped); });
+                        metrics.function("chat_history_fsyncs_total", "Lotes gravados com fdatasync (group commit)",
+                                         Kind::Counter, [this] { return static_cast<int64_t>(journal->stats().syncs); });
+                        metrics.function("chat_history_bytes_written_total", "Bytes gravados no log durável", Kind::Counter,
+                                         [this] { return static_cast<int64_t>(journal->stats().bytesWritten); });
+                        metrics.function("chat_history_write_errors_total", "Falhas de E/S do log durável", Kind::Counter,
+                                         [this] { return static_cast<int64_t>(journal->stats().errors); });
+                }
+
+                metrics.function("chat_buffer_pool_requests_total", "Blocos pedidos ao pool de buffers", Kind::Counter,
+                                 [] { return static_cast<int64_t>(BufferPool::instance().stats().requests); });
+                metrics.function("chat_buffer_pool_misses_total", "Blocos do pool de buffers vindos do heap", Kind::Counter,
+                                 [] { return static_cast<int64_t>(BufferPool::instance().stats().misses); });
+                metrics.function("chat_buffer_pool_depot_bytes", "Bytes livres no depósito do pool de buffers", Kind::Gauge,
+                                 [] { return static_cast<int64_t>(BufferPool::instance().stats().depotBytes); });
+                metrics.function("chat_slab_requests_total", "Objetos de conexão pedidos às arenas", Kind::Counter,
+                                 [] { return static_cast<int64_t>(SlabArena::totalRequests()); });
+                metrics.function("chat_slab_misses_total", "Objetos de conexão em slots nunca usados", Kind::Counter,
+                                 [] { return static_cast<int64_t>(SlabArena::totalMisses()); });
+
+                if (pool) {
+                        metrics.function("chat_pool_workers", "Threads do pool de workers", Kind::Gauge,
+                                         [this] { return static_cast<int64_t>(pool->workerCount()); });
+                        metrics.function("chat_pool_queue_depth", "Tarefas aguardando nas filas do pool", Kind::Gauge,
+                                         [this] { return static_cast<int64_t>(pool->queueDepth()); });
+                        metrics.function("chat_pool_tasks_total", "Tarefas executadas pelo pool", Kind::Counter,
+                                         [this] { return static_cast<int64_t>(pool->executedCount()); });
+                        metrics.function("chat_pool_steals_total", "Tarefas roubadas da fila de outro worker", Kind::Counter,
+                                         [this] { return static_cast<int64_t>(pool->stealCount()); });
+                }
+        }
+
+        // Endpoint de métricas: laço de eventos próprio, uma corrotina por conexão
+        void runAdminEndpoint(int adminSocket) {
+                SocketGuard listener(adminSocket);
+                EventLoop loop(16);
+                std::unordered_set<AsyncSocket*> open; // corrotinas suspensas, para o encerramento
+
+                if (!loop.isValid() || !setNonBlocking(listener.get())) {
+                        logger.error(LogEvent::Error, "Falha ao iniciar o endpoint de métricas");
+                        return;
+                }
+
+                acceptScrapes(loop, listener.get(), open);
+
+                // Timeout de 1 segundo para verificar running
+                while (running && loop.poll(1000) >= 0) {
+                }
+
+                // Cada corrotina retomada sai do conjunto e libera o próprio quadro
+                while (!open.empty()) {
+                        (*open.begin())->cancel();
+                }
+        }
+
+        DetachedTask acceptScrapes(EventLoop& loop, int listenSocket, std::unordered_set<AsyncSocket*>& open) {
+                AsyncSocket listener(loop, listenSocket, EPOLLIN | EPOLLET);
+                open.insert(&listener);
+
+                while (running) {
+                        int fd = static_cast<int>(co_await listener.accept());
+                        if (fd < 0) {
+                                break;
+                        }
+                        serveScrape(loop, SocketGuard(fd), open);
+                }
+
+                open.erase(&listener);
+        }
+
+        // Uma resposta HTTP/1.0 em texto; o conteúdo do pedido é ignorado
+        DetachedTask serveScrape(EventLoop& loop, SocketGuard connection, std::unordered_set<AsyncSocket*>& open) {
+                AsyncSocket socket(loop, connection.get(), EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET);
+                open.insert(&socket);
+
+                char request[1024];
+                if (co_await socket.recv(request, sizeof(request)) > 0) {
+                        std::string body = metrics.renderText();
+                        std::string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                                               std::to_string(body.size()) + "\r\n\r\n" + body;
+                        co_await socket.send(response);
+                }
+
+                open.erase(&socket);
+        }
+
+        // Cria, configura e coloca em escuta um socket TCP
+        int openListenSocket(int listenPort, bool reusePort, in_addr_t address = INADDR_ANY) {
                 // RAII: Socket será fechado automaticamente em caso de exceção
                 SocketGuard serverSock(socket(AF_INET, SOCK_STREAM, 0));
 
                 if (!serverSock.is_valid()) {
-                        logger.log("ERRO: Falha ao criar socket");
-                        return;
+                        logger.error(LogEvent::Error, "Falha ao criar socket");
+                        return -1;
                 }
 
                 // Permitir reutilização rápida da porta
                 int opt = 1;
                 setsockopt(serverSock.get(), SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
 
+                // SO_REUSEPORT: o kernel distribui as conexões entre os sockets do grupo
+                if (reusePort && setsockopt(serverSock.get(), SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+                        logger.error(LogEvent::Error, "SO_REUSEPORT indisponível");
+                        return -1;
+                }
+
                 // Configurar endereço
                 sockaddr_in serverAddr{};
                 serverAddr.sin_family = AF_INET;
-                serverAddr.sin_addr.s_addr = INADDR_ANY;
-                serverAddr.sin_port = htons(port);
+                serverAddr.sin_addr.s_addr = htonl(address);
+                serverAddr.sin_port = htons(listenPort);
 
                 // Bind e Listen
                 if (bind(serverSock.get(), (sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
-                        logger.log("ERRO: Falha no bind");
-                        return;
+                        logger.error(LogEvent::Error, "Falha no bind");
+                        return -1;
                 }
 
-                listen(serverSock.get(), 10);
-                logger.log("Servidor ouvindo conexões na porta " + std::to_string(port));
+                if (listen(serverSock.get(), backlog) < 0) {
+                        logger.error(LogEvent::Error, "Falha no listen");
+                        return -1;
+                }
 
                 // Liberar o socket para uso contínuo
-                serverSocket = serverSock.release();
+                return serverSock.release();
+        }
 
-                std::thread commandThread(&TCPChatServer::commandLoop, this);
-                commandThread.detach();
+        void printStatus() {
+                std::cout << "Clientes conectados: " << registry.size() << std::endl;
+                if (shards.size() > 1) {
+                        for (const auto& shard : shards) {
+                                std::cout << "  shard " << shard->index << ": " << shard->clientCount << std::endl;
+                        }
+                }
+                size_t historySize = 0;
+                size_t roomCount = 0;
+                rooms.forEach([&](Room& room) {
+                        historySize += room.history().size();
+                        roomCount++;
+                });
+                std::cout << "Salas: " << roomCount << std::endl;
+                std::cout << "Mensagens no histórico: " << historySize << std::endl;
+                std::cout << "Clientes lentos: " << backpressure.droppedOldest << " antigas descartadas, "
+                          << backpressure.droppedNew << " novas descartadas, "
+                          << backpressure.disconnected << " desconexões" << std::endl;
+                std::cout << "Log: " << logger.droppedCount() << " entradas descartadas, "
+                          << logger.truncatedCount() << " truncadas" << std::endl;
+                auto now = std::chrono::steady_clock::now();
+                uint64_t accepts = acceptsTotal.value();
+                double interval = std::chrono::duration<double>(now - statusTime).count();
+                std::cout << "Conexões: " << accepts << " aceitas ("
+                          << (interval > 0 ? static_cast<uint64_t>((accepts - statusAccepts) / interval) : 0)
+                          << "/s desde o último status), " << disconnectsTotal.value() << " encerradas" << std::endl;
+                statusAccepts = accepts;
+                statusTime = now;
+                std::cout << "Mensagens: " << messagesReceived.value() << " recebidas, "
+                          << deliveriesTotal.value() << " entregas, "
+                          << bytesReceived.value() << " bytes lidos, "
+                          << bytesQueued.value() << " bytes enfileirados, "
+                          << flushesTotal.value() << " descargas" << std::endl;
+                if (pool) {
+                        std::cout << "Pool: " << pool->workerCount() << " workers, " << pool->queueDepth()
+                                  << " tarefas na fila, " << pool->executedCount() << " executadas, "
+                                  << pool->stealCount() << " roubadas" << std::endl;
+                }
+                if (batchWindowUs > 0) {
+                        std::cout << "Agrupamento de envios: janela de " << batchWindowUs << " µs, limite de "
+                                  << batchMaxBytes << " bytes" << std::endl;
+                }
+                if (journal && journal->isOpen()) {
+                        HistoryJournal::Stats durable = journal->stats();
+                        std::cout << "Histórico em disco: " << durable.appended << " mensagens, " << durable.syncs
+                                  << " fdatasync, " << durable.bytesWritten << " bytes gravados, " << durable.dropped
+                                  << " descartadas, " << durable.errors << " erros" << std::endl;
+                }
+                printConnectionMemory();
+                printPoolHitRates();
+                printLatency("Latência de accept", acceptLatency);
+                printLatency("Latência accept→histórico", joinLatency);
+                printLatency("Latência recepção→fan-out", fanoutLatency);
+                if (shards.size() > 1) {
+                        printLatency("Latência entre shards", crossShardLatency);
+                }
+        }
 
-                // Loop principal de accept
-                while (running) {
-                        sockaddr_in clientAddr{};
-                        socklen_t clientLen = sizeof(clientAddr);
+        static void printLatency(const char* label, const LatencyHistogram& histogram) {
+                std::cout << label << " (µs): p50 " << histogram.percentile(0.5) / 1000
+                          << ", p99 " << histogram.percentile(0.99) / 1000
+                          << ", máx " << histogram.max() / 1000
+                          << " (" << histogram.count() << " amostras)" << std::endl;
+        }
+
+        // Custo de memória por conexão do modo atual, comparado com a pilha de uma thread
+        void printConnectionMemory() {
+                CoroutineFrameStats frames = coroutineFrameStats();
+                std::cout << "Memória por conexão: ClientInfo " << sizeof(ClientInfo) << " B + buffer de leitura "
+                          << RECV_CHUNK_SIZE / 1024 << " KiB (após a primeira leitura)";
+                if (mode == ServerMode::Threads) {
+                        std::cout << " + pilha da thread " << defaultThreadStackSize() / 1024 << " KiB (reservada)";
+                } else if (mode == ServerMode::Coro && frames.liveFrames > 0) {
+                        std::cout << " + quadro da corrotina ~" << frames.liveBytes / frames.liveFrames << " B ("
+                                  << "modo threads: pilha de " << defaultThreadStackSize() / 1024 << " KiB)";
+                }
+                std::cout << std::endl;
+        }
+
+        // Acertos = pedidos atendidos sem ir ao heap
+        static void printPoolHitRates() {
+                BufferPool::Stats buffers = BufferPool::instance().stats();
+                uint64_t slabRequests = SlabArena::totalRequests();
+                uint64_t slabMisses = SlabArena::totalMisses();
+
+                auto hitRate = [](uint64_t requests, uint64_t misses) {
+                        return requests > misses ? 100.0 * static_cast<double>(requests - misses) / requests : 0.0;
+                };
+
+                std::cout << "Pools de memória: buffers " << std::fixed << std::setprecision(1)
+                          << hitRate(buffers.requests, buffers.misses) << "% de acertos (" << buffers.requests
+                          << " pedidos, " << buffers.misses << " do heap, " << buffers.depotBytes / 1024
+                          << " KiB no depósito), conexões " << hitRate(slabRequests, slabMisses) << "% ("
+                          << slabRequests << " pedidos)" << std::defaultfloat << std::endl;
+        }
 
-                        fd_set readfds;
-                        FD_ZERO(&readfds);
-                        FD_SET(serverSocket, &readfds);
+        static size_t defaultThreadStackSize() {
+                pthread_attr_t attr;
+                size_t size = 0;
+                if (pthread_attr_init(&attr) == 0) {
+                        pthread_attr_getstacksize(&attr, &size);
+                        pthread_attr_destroy(&attr);
+                }
+                return size;
+        }
+
+        static uint64_t elapsedNs(std::chrono::steady_clock::time_point since) {
+                return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - since).count());
+        }
+
+        static int64_t steadyNs() {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // Modelo original: 1 thread por cliente. A thread de accept só aceita;
+        // o histórico é enviado pela thread do próprio cliente
+        void runAcceptLoop() {
+                if (!setNonBlocking(serverSocket)) {
+                        logger.error(LogEvent::Error, "Falha ao tornar socket de escuta não bloqueante");
+                        return;
+                }
 
-                        struct timeval tv;
-                        tv.tv_sec = 1; // Timeout de 1 segundo
-                        tv.tv_usec = 0;
+                while (running) {
+                        pollfd pfd{};
+                        pfd.fd = serverSocket;
+                        pfd.events = POLLIN;
 
-                        int activity = select(serverSocket + 1, &readfds, NULL, NULL, &tv);
+                        // Timeout de 1 segundo para verificar running
+                        int ready = poll(&pfd, 1, 1000);
 
-                        if (activity < 0) {
+                        if (ready < 0) {
+                                if (errno == EINTR) {
+                                        continue;
+                                }
                                 if (running) {
-                                        logger.log("ERRO: Select falhou");
+                                        logger.error(LogEvent::Error, "Poll falhou");
                                 }
                                 break;
                         }
 
-                        if (activity == 0) {
-                                // Timeout - continua loop para verificar running
+                        if (ready == 0) {
                                 continue;
                         }
 
-                        int clientSocket = accept(serverSocket, (sockaddr*)&clientAddr, &clientLen);
+                        acceptAll(serverSocket, [this](int clientSocket, int clientId) {
+                                logger.info(LogEvent::ClientConnected, clientId, clientSocket);
+
+                                // Criar ClientInfo com smart pointer
+                                auto client = makeClient(clientSocket, clientId);
+                                client->acceptedAt = std::chrono::steady_clock::now();
+
+                                registry.insert(clientId, client);
+                                joinRoom(*client, rooms.getOrCreate(DEFAULT_ROOM));
+
+                                // Criar thread com lambda
+                                client->thread = std::make_unique<std::thread>(
+                                    [this, client]() { handleClient(client); });
+                                client->thread->detach();
+                        });
+                }
+        }
+
+        // ClientInfo e bloco de controle do shared_ptr num único slot da arena:
+        // conexões novas reaproveitam os slots das que fecharam
+        std::shared_ptr<ClientInfo> makeClient(int clientSocket, int clientId) {
+                auto client = std::allocate_shared<ClientInfo>(SlabAllocator<ClientInfo>(), clientSocket, clientId,
+                                                               queueLimit, slowPolicy);
+                client->lastActivityNs.store(steadyNs(), std::memory_order_relaxed);
+                return client;
+        }
+
+        // Aceita todas as conexões pendentes até EAGAIN; já nascem não bloqueantes e
+        // com CLOEXEC. onAccept(socket, id) recebe cada conexão
+        template <typename OnAccept>
+        void acceptAll(int listenSocket, OnAccept onAccept) {
+                auto wokeAt = std::chrono::steady_clock::now();
+                uint64_t accepted = 0;
+
+                while (running) {
+                        int clientSocket = accept4(listenSocket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
 
                         if (clientSocket < 0) {
+                                if (errno == EINTR || errno == ECONNABORTED) {
+                                        continue;
+                                }
+                                if (errno != EAGAIN && errno != EWOULDBLOCK && running) {
+                                        logger.error(LogEvent::Error, "Accept falhou");
+                                }
+                                break;
+                        }
+
+                        acceptLatency.record(elapsedNs(wokeAt));
+                        acceptsTotal.add();
+                        accepted++;
+                        onAccept(clientSocket, nextClientId++);
+                }
+
+                if (accepted > 0) {
+                        acceptBatch.record(accepted);
+                }
+        }
+
+        // Primeiro envio ao cliente: o bloco do histórico da sala
+        void sendWelcome(ClientInfo& client) {
+                sendHistoryToClient(client);
+                joinLatency.record(elapsedNs(client.acceptedAt));
+        }
+
+        // Shard 0 usa o socket principal; no modo sharded os demais abrem o seu com SO_REUSEPORT
+        bool createShards() {
+                for (unsigned i = 0; i < shardCount; ++i) {
+                        auto shard = std::make_unique<Shard>(i);
+
+                        if (!shard->loop.isValid() || shard->wakeFd < 0 || shard->batchTimerFd < 0) {
+                                logger.error(LogEvent::ShardError, "Falha ao inicializar epoll", i);
+                                return false;
+                        }
+
+                        shard->listenSocket = (i == 0) ? serverSocket : openListenSocket(port, true);
+                        if (shard->listenSocket < 0) {
+                                return false;
+                        }
+
+                        shards.push_back(std::move(shard));
+                }
+                return true;
+        }
+
+        // Modelo reator: cada shard roda seu laço epoll edge-triggered em uma thread
+        void runShards() {
+                logger.info(LogEvent::ReactorActive, shards.size());
+                if (pool) {
+                        logger.info(LogEvent::PoolStarted, pool->workerCount());
+                }
+
+                std::vector<std::thread> threads;
+                for (size_t i = 1; i < shards.size(); ++i) {
+                        threads.emplace_back(&TCPChatServer::runShard, this, std::ref(*shards[i]));
+                }
+
+                runShard(*shards[0]);
+
+                for (auto& t : threads) {
+                        t.join();
+                }
+        }
+
+        void runShard(Shard& shard) {
+                if (!setNonBlocking(shard.listenSocket)) {
+                        logger.error(LogEvent::Error, "Falha ao tornar socket de escuta não bloqueante");
+                        return;
+                }
+
+                if (mode == ServerMode::Coro) {
+                        acceptConnections(shard);
+                } else if (!shard.loop.add(shard.listenSocket, EPOLLIN | EPOLLET, [this, &shard](uint32_t) { acceptPending(shard); })) {
+                        logger.error(LogEvent::ShardError, "Falha ao registrar socket de escuta no epoll", shard.index);
+                        return;
+                }
+
+                if (!shard.loop.add(shard.wakeFd, EPOLLIN | EPOLLET, [this, &shard](uint32_t) { drainInbox(shard); }) ||
+                    !shard.loop.add(shard.batchTimerFd, EPOLLIN | EPOLLET, [this, &shard](uint32_t) { flushBatch(shard); })) {
+                        logger.error(LogEvent::ShardError, "Falha ao registrar sockets no epoll", shard.index);
+                        return;
+                }
+
+                while (running) {
+                        // Timeout de 1 segundo para verificar running, como no select()
+                        if (shard.loop.poll(1000) < 0) {
                                 if (running) {
-                                        logger.log("ERRO: Accept falhou");
+                                        logger.error(LogEvent::Error, "epoll_wait falhou");
                                 }
-                                continue;
+                                break;
+                        }
+                }
+
+                // Workers param antes: nenhuma tarefa toca os clientes durante a desmontagem
+                if (pool) {
+                        pool->shutdown();
+                }
+
+                // Modo coro: retoma as corrotinas suspensas; cada uma fecha o próprio cliente
+                if (shard.acceptor) {
+                        shard.acceptor->cancel();
+                }
+                std::vector<std::shared_ptr<ClientInfo>> suspended;
+                for (auto& entry : shard.clients) {
+                        if (entry.second->async) {
+                                suspended.push_back(entry.second);
+                        }
+                }
+                for (auto& client : suspended) {
+                        if (client->async) {
+                                client->async->cancel();
+                        }
+                }
+
+                // Encerramento: o shard fecha os próprios clientes
+                for (auto& entry : shard.clients) {
+                        ::shutdown(entry.first, SHUT_RDWR);
+                        shard.loop.remove(entry.first);
+                        detachClient(*entry.second);
+                }
+                shard.batchDirty.clear();
+                shard.clients.clear(); // últimas referências: SocketGuard fecha os sockets
+                shard.clientCount = 0;
+
+                // O socket do shard 0 é o principal, fechado por shutdown()
+                if (shard.index != 0) {
+                        close(shard.listenSocket);
+                }
+        }
+
+        // Edge-triggered: aceita todas as conexões pendentes antes de enviar
+        // qualquer histórico, para esvaziar a fila do kernel o quanto antes
+        void acceptPending(Shard& shard) {
+                std::vector<std::shared_ptr<ClientInfo>> accepted;
+
+                acceptAll(shard.listenSocket, [&](int clientSocket, int clientId) {
+                        logger.info(LogEvent::ClientConnectedShard, clientId, clientSocket, shard.index);
+
+                        auto client = makeClient(clientSocket, clientId);
+                        client->acceptedAt = std::chrono::steady_clock::now();
+                        client->shard = &shard;
+                        if (pool) {
+                                client->strand = std::allocate_shared<Strand>(SlabAllocator<Strand>(), *pool);
+                        }
+
+                        shard.clients[clientSocket] = client;
+                        shard.clientCount++;
+                        registry.insert(clientId, client);
+                        joinRoom(*client, rooms.getOrCreate(DEFAULT_ROOM));
+
+                        // Modo pool: o laço só detecta prontidão; leitura e processamento vão para os workers
+                        shard.loop.add(clientSocket, EPOLLIN | EPOLLRDHUP | EPOLLET, [this, client](uint32_t events) {
+                                if (client->strand) {
+                                        client->strand->post([this, client, events] { onClientEvent(client, events); });
+                                } else {
+                                        onClientEvent(client, events);
+                                }
+                        });
+                        accepted.push_back(std::move(client));
+                });
+
+                for (const auto& client : accepted) {
+                        if (client->strand) {
+                                client->strand->post([this, client] { sendWelcome(*client); });
+                        } else {
+                                sendWelcome(*client);
                         }
+                        armLiveness(shard, client);
+                }
+        }
+
+        // Modo coro: cada co_await accept() devolve uma conexão; enquanto houver
+        // pendentes ele completa sem suspender, esvaziando a fila do kernel
+        DetachedTask acceptConnections(Shard& shard) {
+                AsyncSocket listener(shard.loop, shard.listenSocket, EPOLLIN | EPOLLET);
+                if (!listener.isValid()) {
+                        logger.error(LogEvent::ShardError, "Falha ao registrar socket de escuta no epoll", shard.index);
+                        co_return;
+                }
+                shard.acceptor = &listener;
 
-                        if (!running) {
-                                close(clientSocket);
+                while (running) {
+                        int clientSocket = static_cast<int>(co_await listener.accept());
+                        if (clientSocket < 0) {
+                                if (errno != ECANCELED && running) {
+                                        logger.error(LogEvent::Error, "Accept falhou");
+                                }
                                 break;
                         }
 
+                        acceptsTotal.add();
                         int clientId = nextClientId++;
-                        logger.log("Cliente " + std::to_string(clientId) + " conectado (socket: " + std::to_string(clientSocket) + ")");
+                        logger.info(LogEvent::ClientConnectedShard, clientId, clientSocket, shard.index);
 
-                        // Criar ClientInfo com smart pointer
-                        auto client = std::make_shared<ClientInfo>(clientSocket, clientId);
+                        auto client = makeClient(clientSocket, clientId);
+                        client->acceptedAt = std::chrono::steady_clock::now();
+                        client->shard = &shard;
+
+                        shard.clients[clientSocket] = client;
+                        shard.clientCount++;
+                        registry.insert(clientId, client);
+                        joinRoom(*client, rooms.getOrCreate(DEFAULT_ROOM));
+                        armLiveness(shard, client);
+
+                        serveClient(shard, std::move(client));
+                }
+
+                shard.acceptor = nullptr;
+        }
+
+        // Modo coro: o atendimento inteiro em código sequencial. O quadro guarda a
+        // referência ao ClientInfo (e ao SocketGuard dele) enquanto a conexão existir;
+        // o fan-out continua pela fila de saída compartilhada com os outros modos
+        DetachedTask serveClient(Shard& shard, std::shared_ptr<ClientInfo> client) {
+                AsyncSocket socket(shard.loop, client->socket);
+                if (!socket.isValid()) {
+                        closeClient(client);
+                        co_return;
+                }
+                socket.onWritable([this, &info = *client] { flushClient(info); });
+                client->async = &socket;
 
-                        {
-                                std::lock_guard<std::mutex> lock(clientsMutex);
-                                clients.push_back(client);
+                sendWelcome(*client);
+
+                while (running) {
+                        // Só reserva o buffer de leitura quando há dados: conexão ociosa não o aloca
+                        if (co_await socket.readable() < 0) {
+                                break;
                         }
 
-                        // Enviar histórico
-                        sendHistoryToClient(clientSocket);
+                        char* space = client->framer.prepareWrite(RECV_CHUNK_SIZE);
+                        ssize_t bytesRead = co_await socket.recv(space, RECV_CHUNK_SIZE);
+
+                        if (bytesRead <= 0) {
+                                if (bytesRead == 0 || errno != ECANCELED) {
+                                        logger.info(LogEvent::ClientDisconnected, client->clientId);
+                                }
+                                break;
+                        }
 
-                        // Criar thread com lambda
-                        client->thread = std::make_unique<std::thread>(
-                            [this, client]() { handleClient(client); });
-                        client->thread->detach();
+                        bytesReceived.add(static_cast<uint64_t>(bytesRead));
+                        client->lastActivityNs.store(steadyNs(), std::memory_order_relaxed);
+                        client->framer.commitWrite(bytesRead);
+                        processInput(*client);
                 }
 
-                logger.log("Loop principal do servidor encerrado");
+                client->async = nullptr;
+                closeClient(client);
+        }
 
-                if (commandThread.joinable()) {
-                        commandThread.join();
+        void onClientEvent(const std::shared_ptr<ClientInfo>& client, uint32_t events) {
+                if (events & EPOLLOUT) {
+                        flushClient(*client);
+                }
+
+                if (!(events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+                        return;
+                }
+
+                // Edge-triggered: ler até esgotar o socket
+                while (running) {
+                        char* space = client->framer.prepareWrite(RECV_CHUNK_SIZE);
+                        ssize_t bytesRead = recv(client->socket, space, RECV_CHUNK_SIZE, 0);
+
+                        if (bytesRead < 0 && errno == EINTR) {
+                                continue;
+                        }
+
+                        if (bytesRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                                return;
+                        }
+
+                        if (bytesRead <= 0) {
+                                logger.info(LogEvent::ClientDisconnected, client->clientId);
+                                requestClose(client);
+                                return;
+                        }
+
+                        bytesReceived.add(static_cast<uint64_t>(bytesRead));
+                        client->lastActivityNs.store(steadyNs(), std::memory_order_relaxed);
+                        client->framer.commitWrite(bytesRead);
+                        processInput(*client);
                 }
         }
 
-private:
-        void handleClient(std::shared_ptr<ClientInfo> client) {
-                // RAII: Socket fechado automaticamente ao sair do escopo
-                SocketGuard sockGuard(client->socket);
+        // Só a thread do shard altera o epoll e a tabela de clientes; workers pedem pela inbox
+        void requestClose(const std::shared_ptr<ClientInfo>& client) {
+                if (!client->strand) {
+                        closeClient(client);
+                        return;
+                }
+
+                Shard& shard = *client->shard;
+                {
+                        std::lock_guard<std::mutex> lock(shard.inboxMutex);
+                        shard.closeRequests.push_back(client);
+                }
+                shard.wake();
+        }
 
-                logger.log("Thread iniciada para Cliente " + std::to_string(client->clientId));
+        void closeClient(const std::shared_ptr<ClientInfo>& client) {
+                Shard& shard = *client->shard;
+                shard.loop.timers().cancel(client->livenessTimer);
+                client->livenessTimer = 0;
+                shard.loop.remove(client->socket);
+                if (shard.clients.erase(client->socket)) {
+                        shard.clientCount--;
+                        detachClient(*client);
+                }
+        }
 
-                char buffer[1024];
+        void handleClient(std::shared_ptr<ClientInfo> client) {
+                logger.debug(LogEvent::ClientThreadStarted, client->clientId);
+                sendWelcome(*client);
+
+                // A thread já acorda a cada 100 ms: ela mesma verifica a ociosidade
+                int64_t nextCheckNs = livenessEnabled() ? steadyNs() + checkLiveness(*client) : INT64_MAX;
 
                 while (running) {
-                        int bytesRead = recv(sockGuard.get(), buffer, sizeof(buffer) - 1, 0);
+                        if (steadyNs() >= nextCheckNs) {
+                                int64_t next = checkLiveness(*client);
+                                nextCheckNs = next < 0 ? INT64_MAX : steadyNs() + next;
+                        }
+
+                        pollfd pfd{};
+                        pfd.fd = client->socket;
+                        pfd.events = POLLIN | (client->outbound.empty() ? 0 : POLLOUT);
+
+                        // Timeout curto: outras threads podem enfileirar durante a espera
+                        int ready = poll(&pfd, 1, 100);
+
+                        if (ready < 0 && errno == EINTR) {
+                                continue;
+                        }
+
+                        if (ready > 0 && !(pfd.revents & (POLLIN | POLLHUP | POLLERR))) {
+                                flushClient(*client);
+                                continue;
+                        }
+
+                        if (ready == 0) {
+                                if (!client->outbound.empty()) {
+                                        flushClient(*client);
+                                }
+                                continue;
+                        }
+
+                        char* space = client->framer.prepareWrite(RECV_CHUNK_SIZE);
+                        ssize_t bytesRead = ready < 0 ? -1 : recv(client->socket, space, RECV_CHUNK_SIZE, 0);
+
+                        // Socket não bloqueante: prontidão espúria não é desconexão
+                        if (bytesRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                                continue;
+                        }
 
                         if (bytesRead <= 0) {
-                                logger.log("Cliente " + std::to_string(client->clientId) + " desconectado");
-                                removeClient(sockGuard.get());
+                                logger.info(LogEvent::ClientDisconnected, client->clientId);
+                                detachClient(*client);
                                 break;
                         }
 
-                        buffer[bytesRead] = '\0';
-                        std::string message(buffer);
+                        bytesReceived.add(static_cast<uint64_t>(bytesRead));
+                        client->lastActivityNs.store(steadyNs(), std::memory_order_relaxed);
+                        client->framer.commitWrite(bytesRead);
+                        processInput(*client);
+                }
+        }
+
+        // Processa os bytes recebidos conforme o protocolo do cliente
+        void processInput(ClientInfo& client) {
+                if (client.protocol == ClientProtocol::Unknown && !detectProtocol(client)) {
+                        return;
+                }
+
+                if (client.protocol == ClientProtocol::Binary) {
+                        processFrames(client);
+                } else {
+                        processLines(client);
+                }
+        }
+
+        // Retorna false enquanto não há bytes suficientes para decidir
+        bool detectProtocol(ClientInfo& client) {
+                std::string_view data = client.framer.pending();
+                std::string_view hello(BINARY_HELLO, BINARY_HELLO_SIZE);
+
+                if (data.empty() || (data[0] == '\0' && data.size() < hello.size())) {
+                        return false;
+                }
+
+                if (data.substr(0, hello.size()) != hello) {
+                        client.protocol = ClientProtocol::Text;
+                        return true;
+                }
+
+                client.framer.consume(hello.size());
+                client.protocol = ClientProtocol::Binary;
+                logger.info(LogEvent::BinaryNegotiated, client.clientId);
+
+                // Confirmação: a partir daqui o cliente só recebe quadros
+                sendToClient(client, makeSharedBuffer(hello));
+                sendHistoryFrames(client);
+                return true;
+        }
+
+        void processFrames(ClientInfo& client) {
+                FrameHeader header;
+                std::string_view payload;
+                size_t consumed = 0;
 
-                        // Remover \r e \n do final
-                        while (!message.empty() && (message.back() == '\n' || message.back() == '\r')) {
-                                message.pop_back();
+                for (;;) {
+                        DecodeStatus status = decodeFrame(client.framer.pending(), header, payload, consumed);
+
+                        if (status == DecodeStatus::Incomplete) {
+                                return;
                         }
 
-                        if (message.empty())
-                                continue;
+                        // Texto de chat é uma linha só: CR/LF no payload forjaria linhas
+                        // (e remetentes) para os clientes de texto, o histórico e o índice
+                        if (status == DecodeStatus::Complete && header.type == FrameType::Chat &&
+                            payload.find_first_of("\r\n") != std::string_view::npos) {
+                                status = DecodeStatus::Invalid;
+                        }
 
-                        logger.log("Mensagem recebida do Cliente " + std::to_string(client->clientId) + ": " + message);
+                        if (status == DecodeStatus::Invalid) {
+                                logger.warn(LogEvent::InvalidFrame, client.clientId);
+                                ::shutdown(client.socket, SHUT_RDWR);
+                                return;
+                        }
 
-                        // Retransmitir
-                        broadcastMessage(message, sockGuard.get());
+                        if (header.type == FrameType::Chat && !payload.empty()) {
+                                handleMessage(client, payload);
+                        }
+                        client.framer.consume(consumed);
                 }
         }
 
-        void broadcastMessage(const std::string& message, int senderSocket) {
-                std::lock_guard<std::mutex> lock(clientsMutex);
+        // Extrai todas as linhas completas já recebidas
+        void processLines(ClientInfo& client) {
+                std::string_view line;
+                while (client.framer.nextLine(line)) {
+                        if (!line.empty()) {
+                                handleMessage(client, line);
+                        }
+                }
+        }
 
-                // Encontrar o clientId do socket
-                int senderClientId = 0;
-                for (const auto& client : clients) {
-                        if (client->socket == senderSocket) {
-                                senderClientId = client->clientId;
-                                break;
+        // Remove o cliente do registro e da sala
+        void detachClient(ClientInfo& client) {
+                if (registry.erase(client.clientId)) {
+                        disconnectsTotal.add();
+                }
+                if (client.room) {
+                        client.room->leave(shardOf(client), client.clientId);
+                }
+        }
+
+        static size_t shardOf(const ClientInfo& client) {
+                return client.shard ? static_cast<size_t>(client.shard->index) : 0;
+        }
+
+        // Move o cliente para a sala; deve ser chamado pela thread dona do cliente
+        void joinRoom(ClientInfo& client, const RoomPtr& room) {
+                size_t shard = shardOf(client);
+                if (client.room) {
+                        client.room->leave(shard, client.clientId);
+                }
+                client.room = room;
+                room->join(shard, client.clientId, client.shared_from_this());
+        }
+
+        // Comandos de cliente começam com '/'; retorna false para mensagens comuns
+        bool handleCommand(ClientInfo& client, std::string_view message) {
+                if (message.empty() || message[0] != '/') {
+                        return false;
+                }
+
+                size_t space = message.find(' ');
+                std::string_view command = message.substr(0, space);
+                std::string_view argument = space == std::string_view::npos ? std::string_view() : message.substr(space + 1);
+                while (!argument.empty() && argument.front() == ' ') {
+                        argument.remove_prefix(1);
+                }
+
+                if (command == "/join" || command == "/leave") {
+                        std::string name = command == "/leave" ? DEFAULT_ROOM : std::string(argument);
+                        if (!isValidRoomName(name)) {
+                                sendSystem(client, "Nome de sala inválido (use até 32 letras, dígitos, '-' ou '_')");
+                                return true;
                         }
+
+                        RoomPtr room = rooms.getOrCreate(name);
+                        if (!room) {
+                                logger.warn(LogEvent::RoomLimitReached, rooms.limit(), name);
+                                sendSystem(client, "Limite de " + std::to_string(rooms.limit()) +
+                                                           " salas atingido; entre em uma sala existente (/rooms)");
+                                return true;
+                        }
+                        joinRoom(client, room);
+                        logger.info(LogEvent::RoomJoined, client.clientId, name);
+                        sendSystem(client, "Você entrou na sala '" + name + "' (" + std::to_string(room->memberCount()) + " membro(s))");
+                        if (client.protocol == ClientProtocol::Binary) {
+                                sendHistoryFrames(client);
+                        } else {
+                                sendHistoryToClient(client);
+                        }
+                } else if (command == "/resume") {
+                        uint64_t after = 0;
+                        auto parsed = std::from_chars(argument.data(), argument.data() + argument.size(), after);
+                        if (argument.empty() || parsed.ec != std::errc() || parsed.ptr != argument.data() + argument.size()) {
+                                sendSystem(client, "Uso: /resume <última sequência recebida>");
+                                return true;
+                        }
+                        sendMissed(client, after);
+                } else if (command == "/msg") {
+                        size_t split = argument.find(' ');
+                        std::string_view target = argument.substr(0, split);
+                        std::string_view text = split == std::string_view::npos ? std::string_view() : argument.substr(split + 1);
+                        int recipientId = 0;
+                        auto parsed = std::from_chars(target.data(), target.data() + target.size(), recipientId);
+                        if (target.empty() || parsed.ec != std::errc() || parsed.ptr != target.data() + target.size() ||
+                            text.empty()) {
+                                sendSystem(client, "Uso: /msg <id do cliente> <texto>");
+                                return true;
+                        }
+                        sendDirect(client, recipientId, text);
+                } else if (command == "/search") {
+                        sendSearch(client, argument);
+                } else if (command == "/rooms") {
+                        std::string list = "Salas:";
+                        for (const auto& room : rooms.list()) {
+                                list += " " + room.first + "(" + std::to_string(room.second) + ")";
+                        }
+                        sendSystem(client, list);
+                } else {
+                        sendSystem(client, "Comando desconhecido. Use /join <sala>, /leave, /rooms, /msg <id> <texto>, /resume <seq> ou /search <termos>");
                 }
+                return true;
+        }
+
+        static bool isValidRoomName(const std::string& name) {
+                if (name.empty() || name.size() > 32) {
+                        return false;
+                }
+                return std::all_of(name.begin(), name.end(), [](char c) {
+                        return std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_';
+                });
+        }
+
+        // Aviso do servidor para um único cliente
+        void sendSystem(ClientInfo& client, const std::string& text) {
+                if (client.protocol == ClientProtocol::Binary) {
+                        sendToClient(client, encodeFrame(FrameType::System, 0, 0, text));
+                } else {
+                        sendToClient(client, makeSharedBuffer("=== " + text + " ===\n"));
+                }
+        }
 
-                std::string fullMessage = "Cliente " + std::to_string(senderClientId) + ": " + message;
+        void handleMessage(ClientInfo& client, std::string_view message) {
+                if (handleCommand(client, message)) {
+                        return;
+                }
+
+                messagesReceived.add();
+                logger.debug(LogEvent::MessageReceived, client.clientId, message);
+
+                // Retransmitir
+                if (client.shard) {
+                        broadcastFromShard(*client.shard, client, message);
+                } else {
+                        broadcastMessage(client, message);
+                }
+        }
 
-                // Adicionar ao histórico
-                messageHistory.addMessage(fullMessage, senderSocket);
+        // Modo threads: percorre um snapshot dos assinantes da sala, sem trava global
+        void broadcastMessage(const ClientInfo& sender, std::string_view message) {
+                RoomPtr room = sender.room;
+                ChatMessage chat = encodeChatMessage(sender.clientId, message);
 
-                // Adicionar \n para framing
-                fullMessage += "\n";
+                // Adicionar ao histórico da sala (compartilha o mesmo buffer); ele numera a mensagem
+                chat.sequence = room->history().addMessage(chat.text, sender.socket);
 
-                // Usar range-based for com smart pointers
-                for (const auto& client : clients) {
-                        if (client->socket != senderSocket) {
-                                send(client->socket, fullMessage.c_str(), fullMessage.length(), 0);
+                SharedBuffer binary;
+                room->subscribers(0).forEach([&](const std::shared_ptr<ClientInfo>& client) {
+                        if (client->clientId != sender.clientId) {
+                                deliverChat(*client, chat, binary);
+                        }
+                });
+                fanoutLatency.record(elapsedNs(chat.receivedAt));
+
+                logger.debug(LogEvent::MessageRelayed, sender.clientId, chat.text->size());
+        }
+
+        // Modos reator: entrega aos assinantes locais da sala e repassa só
+        // aos shards que têm membros dela, pela inbox de cada um
+        void broadcastFromShard(Shard& origin, const ClientInfo& sender, std::string_view message) {
+                RoomPtr room = sender.room;
+                ChatMessage chat = encodeChatMessage(sender.clientId, message);
+
+                // Adicionar ao histórico da sala (compartilha o mesmo buffer); ele numera a mensagem
+                chat.sequence = room->history().addMessage(chat.text, sender.socket);
+
+                deliverLocal(origin, *room, chat, sender.clientId);
+                fanoutLatency.record(elapsedNs(chat.receivedAt));
+
+                for (auto& shard : shards) {
+                        if (shard.get() != &origin && room->shardMembers(shard->index) > 0) {
+                                postToShard(*shard, RoomDelivery{room, chat, nullptr});
                         }
                 }
 
-                logger.log("Mensagem retransmitida: " + fullMessage);
+                logger.debug(LogEvent::MessageRelayed, sender.clientId, chat.text->size());
         }
 
-        void sendHistoryToClient(int clientSocket) {
-                auto history = messageHistory.getRecentMessages(10);
+        // /msg: o destinatário sai do registro por id (O(1), sem trava global) e
+        // recebe só ele. Se outro shard é dono do socket, a entrega vai pela inbox dele
+        void sendDirect(ClientInfo& sender, int recipientId, std::string_view message) {
+                std::shared_ptr<ClientInfo> recipient = registry.find(recipientId);
+                if (!recipient || recipient->closing) {
+                        sendSystem(sender, "Cliente " + std::to_string(recipientId) + " não está conectado");
+                        return;
+                }
+                if (recipient.get() == &sender) {
+                        sendSystem(sender, "Use /msg com o id de outro cliente");
+                        return;
+                }
 
-                std::string historyMsg;
+                ChatMessage chat = encodeChatMessage(sender.clientId, message, "[privado] ");
+                chat.direct = true;
+                directMessages.add();
 
-                if (history.empty()) {
-                        historyMsg = "=== Bem-vindo ao chat! Seja o primeiro a enviar uma mensagem. ===\n";
+                if (!recipient->shard || recipient->shard == sender.shard) {
+                        SharedBuffer binary;
+                        deliverChat(*recipient, chat, binary);
                 } else {
-                        historyMsg = "=== Últimas " + std::to_string(history.size()) + " mensagens ===\n";
-                        for (const auto& msg : history) {
-                                historyMsg += msg + "\n";
+                        postToShard(*recipient->shard, RoomDelivery{nullptr, chat, recipient});
+                }
+
+                logger.debug(LogEvent::DirectMessage, sender.clientId, recipientId, chat.text->size());
+        }
+
+        // Codifica "Cliente N: texto\n" uma única vez, direto no bloco do pool
+        // ('tag' vem antes, ex.: "[privado] ")
+        ChatMessage encodeChatMessage(int clientId, std::string_view message, std::string_view tag = {}) {
+                static constexpr std::string_view PREFIX = "Cliente ";
+
+                char digits[16];
+                char* digitsEnd = std::to_chars(digits, digits + sizeof(digits), clientId).ptr;
+                size_t prefixSize = tag.size() + PREFIX.size() + (digitsEnd - digits) + 2;
+
+                ChatMessage chat;
+                chat.receivedAt = std::chrono::steady_clock::now();
+                chat.senderId = clientId;
+                chat.payloadOffset = prefixSize;
+                chat.text = SharedBuffer::build(prefixSize + message.size() + 1, [&](char* out) {
+                        out = std::copy(tag.begin(), tag.end(), out);
+                        out = std::copy(PREFIX.begin(), PREFIX.end(), out);
+                        out = std::copy(digits, digitsEnd, out);
+                        *out++ = ':';
+                        *out++ = ' ';
+                        out = std::copy(message.begin(), message.end(), out);
+                        *out = '\n'; // framing
+                });
+                return chat;
+        }
+
+        // Escolhe a codificação do destinatário; binaryCache guarda o quadro já criado
+        void deliverChat(ClientInfo& client, const ChatMessage& chat, SharedBuffer& binaryCache) {
+                deliveriesTotal.add();
+                if (client.protocol != ClientProtocol::Binary) {
+                        sendToClient(client, chat.text);
+                        return;
+                }
+
+                if (!binaryCache) {
+                        binaryCache = encodeFrame(chat.direct ? FrameType::Direct : FrameType::Chat, chat.sequence,
+                                                  chat.senderId, chat.payload());
+                }
+                sendToClient(client, binaryCache);
+        }
+
+        // Deve ser chamado pela thread do shard; custo proporcional aos membros locais da sala
+        void deliverLocal(Shard& shard, const Room& room, const ChatMessage& chat, int skipClientId) {
+                SharedBuffer binary;
+                room.subscribers(shard.index).forEach([&](const std::shared_ptr<ClientInfo>& client) {
+                        if (client->clientId != skipClientId) {
+                                deliverChat(*client, chat, binary);
+                        }
+                });
+        }
+
+        void postToShard(Shard& shard, RoomDelivery delivery) {
+                bool wasEmpty;
+                {
+                        std::lock_guard<std::mutex> lock(shard.inboxMutex);
+                        wasEmpty = shard.inbox.empty();
+                        shard.inbox.push_back(std::move(delivery));
+                }
+                // Só acorda o shard se ele ainda não tinha trabalho pendente
+                if (wasEmpty) {
+                        shard.wake();
+                }
+        }
+
+        void drainInbox(Shard& shard) {
+                uint64_t counter;
+                while (read(shard.wakeFd, &counter, sizeof(counter)) > 0) {
+                }
+
+                std::vector<RoomDelivery>& pending = shard.inboxSpare;
+                std::vector<std::shared_ptr<ClientInfo>>& closing = shard.closeSpare;
+                {
+                        std::lock_guard<std::mutex> lock(shard.inboxMutex);
+                        pending.swap(shard.inbox);
+                        closing.swap(shard.closeRequests);
+                }
+
+                for (const auto& client : closing) {
+                        closeClient(client);
+                }
+
+                for (const auto& delivery : pending) {
+                        if (delivery.recipient) {
+                                if (!delivery.recipient->closing) {
+                                        SharedBuffer binary;
+                                        deliverChat(*delivery.recipient, delivery.chat, binary);
+                                }
+                        } else {
+                                deliverLocal(shard, *delivery.room, delivery.chat, -1);
                         }
-                        historyMsg += "===========================\n";
+                        crossShardLatency.record(elapsedNs(delivery.chat.receivedAt));
                 }
 
-                send(clientSocket, historyMsg.c_str(), historyMsg.length(), 0);
-                logger.log("Histórico enviado ao cliente " + std::to_string(clientSocket));
+                closing.clear();
+                pending.clear();
         }
 
-        void removeClient(int clientSocket) {
-                std::lock_guard<std::mutex> lock(clientsMutex);
+        // O bloco vem pronto do cache do histórico: um único buffer compartilhado
+        void sendHistoryToClient(ClientInfo& client) {
+                sendToClient(client, client.room->history().getRecentBlock(10));
+                logger.debug(LogEvent::HistorySent, client.socket);
+        }
 
-                clients.erase(
-                    std::remove_if(clients.begin(), clients.end(),
-                                   [clientSocket](const auto& client) {
-                                           return client->socket == clientSocket;
-                                   }),
-                    clients.end());
+        // Histórico para clientes binários: um quadro History por linha, com a sequência
+        void sendHistoryFrames(ClientInfo& client) {
+                for (const auto& line : client.room->history().getRecentLines(10)) {
+                        sendToClient(client, encodeFrame(FrameType::History, line.sequence, 0, line.text));
+                }
+        }
+
+        // /resume N: só o que veio depois de N na sala atual. Se parte já saiu
+        // do histórico, avisa a lacuna antes (texto: linha "Lacuna"; binário: quadro Gap)
+        void sendMissed(ClientInfo& client, uint64_t after) {
+                HistorySlice slice = client.room->history().since(after);
+                bool binary = client.protocol == ClientProtocol::Binary;
+
+                if (slice.hasGap(after)) {
+                        std::string gap = "Lacuna: mensagens #" + std::to_string(after + 1) + " a #" +
+                                          std::to_string(slice.firstAvailable - 1) + " não estão mais no histórico";
+                        if (binary) {
+                                sendToClient(client, encodeFrame(FrameType::Gap, slice.firstAvailable, 0, gap));
+                        } else {
+                                sendSystem(client, gap);
+                        }
+                }
+
+                if (slice.lines.empty()) {
+                        sendSystem(client, "Nenhuma mensagem nova depois de #" + std::to_string(after) + " (última: #" +
+                                                   std::to_string(slice.last) + ")");
+                        return;
+                }
+
+                if (binary) {
+                        for (const auto& line : slice.lines) {
+                                sendToClient(client, encodeFrame(FrameType::History, line.sequence, 0, line.text));
+                        }
+                        sendSystem(client, "Retomado até #" + std::to_string(slice.last));
+                        return;
+                }
+
+                std::string block = "=== Retomando depois de #" + std::to_string(after) + ": " +
+                                    std::to_string(slice.lines.size()) + " mensagens (até #" +
+                                    std::to_string(slice.last) + ") ===\n";
+                for (const auto& line : slice.lines) {
+                        block.append(line.text).push_back('\n');
+                }
+                block += "===========================\n";
+                sendToClient(client, makeSharedBuffer(block));
+        }
+
+        // /search: as mensagens mais recentes da sala atual com todos os termos,
+        // em ordem cronológica e com a sequência (que serve de ponto para /resume)
+        void sendSearch(ClientInfo& client, std::string_view query) {
+                std::vector<HistoryLine> lines;
+                auto startedAt = std::chrono::steady_clock::now();
+                bool valid = client.room->history().search(query, SEARCH_LIMIT, lines);
+                searchLatency.record(elapsedNs(startedAt));
+
+                if (!valid) {
+                        sendSystem(client, "Uso: /search <termos> (letras e dígitos; todos precisam aparecer)");
+                        return;
+                }
+
+                std::string summary = "Busca '" + std::string(query) + "': " + std::to_string(lines.size()) +
+                                      " resultado(s)" + (lines.size() == SEARCH_LIMIT ? " (os mais recentes)" : "");
+                if (client.protocol == ClientProtocol::Binary) {
+                        for (const auto& line : lines) {
+                                sendToClient(client, encodeFrame(FrameType::History, line.sequence, 0, line.text));
+                        }
+                        sendSystem(client, summary);
+                        return;
+                }
+
+                std::string block = "=== " + summary + " ===\n";
+                for (const auto& line : lines) {
+                        block.append("#").append(std::to_string(line.sequence)).append(" ").append(line.text).push_back('\n');
+                }
+                block += "===========================\n";
+                sendToClient(client, makeSharedBuffer(block));
+        }
+
+        // Enfileira sem bloquear e tenta drenar: um cliente lento não atrasa os demais.
+        // Modos epoll/sharded: deve ser chamado pela thread do shard dono do cliente
+        void sendToClient(ClientInfo& client, const SharedBuffer& data) {
+                switch (client.outbound.push(data)) {
+                case OutboundQueue::PushResult::Queued:
+                        bytesQueued.add(data->size());
+                        break;
+                case OutboundQueue::PushResult::DroppedOldest:
+                        backpressure.droppedOldest++;
+                        bytesQueued.add(data->size());
+                        break;
+                case OutboundQueue::PushResult::DroppedNew:
+                        backpressure.droppedNew++;
+                        return;
+                case OutboundQueue::PushResult::Overflow:
+                        disconnectSlowConsumer(client);
+                        return;
+                }
+
+                // Aguardando espaço no kernel: o evento de escrita fará o envio
+                if (client.wantWrite) {
+                        return;
+                }
+
+                // Agrupamento: adia a descarga até a janela expirar ou o lote atingir o limite
+                if (batchWindowUs > 0 && client.outbound.bytesPending() < batchMaxBytes) {
+                        scheduleFlush(*client.shard, client);
+                        return;
+                }
+                flushClient(client);
+        }
+
+        // Põe o cliente na lista do shard; o primeiro da lista arma o timer da janela
+        void scheduleFlush(Shard& shard, ClientInfo& client) {
+                if (client.batchPending) {
+                        return;
+                }
+                client.batchPending = true;
+
+                if (shard.batchDirty.empty()) {
+                        itimerspec window{};
+                        window.it_value.tv_sec = batchWindowUs / 1000000;
+                        window.it_value.tv_nsec = static_cast<long>(batchWindowUs % 1000000) * 1000;
+                        timerfd_settime(shard.batchTimerFd, 0, &window, nullptr);
+                }
+                shard.batchDirty.push_back(client.shared_from_this());
+        }
+
+        // Janela expirada: um writev por cliente com tudo o que acumulou
+        void flushBatch(Shard& shard) {
+                uint64_t expirations;
+                while (read(shard.batchTimerFd, &expirations, sizeof(expirations)) > 0) {
+                }
+
+                std::vector<std::shared_ptr<ClientInfo>>& dirty = shard.batchSpare;
+                dirty.swap(shard.batchDirty);
+
+                for (const auto& client : dirty) {
+                        client->batchPending = false;
+                        if (!client->wantWrite && !client->closing) {
+                                flushClient(*client);
+                        }
+                }
+                dirty.clear();
+        }
+
+        void flushClient(ClientInfo& client) {
+                std::lock_guard<std::mutex> lock(client.flushMutex);
+                flushesTotal.add();
+                OutboundQueue::FlushResult result = client.outbound.flush(client.socket, batchWindowUs > 0);
+
+                if (result == OutboundQueue::FlushResult::Error) {
+                        // recv() verá EOF e fará a limpeza normal
+                        ::shutdown(client.socket, SHUT_RDWR);
+                        return;
+                }
+
+                bool wantWrite = result == OutboundQueue::FlushResult::WouldBlock;
+                if (client.shard && wantWrite != client.wantWrite) {
+                        uint32_t events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+                        if (wantWrite) {
+                                events |= EPOLLOUT;
+                        }
+                        client.shard->loop.modify(client.socket, events);
+                }
+                client.wantWrite = wantWrite;
+        }
+
+        bool livenessEnabled() const {
+                return idleTimeoutNs > 0 || heartbeatNs > 0;
+        }
+
+        // Modos reator: um temporizador por conexão na roda do shard, reagendado só
+        // quando dispara. Receber dados só grava lastActivityNs, sem mexer na roda
+        void armLiveness(Shard& shard, const std::shared_ptr<ClientInfo>& client) {
+                if (livenessEnabled()) {
+                        scheduleLiveness(shard, client, checkLiveness(*client));
+                }
+        }
+
+        void scheduleLiveness(Shard& shard, const std::shared_ptr<ClientInfo>& client, int64_t delayNs) {
+                if (delayNs < 0) {
+                        return;
+                }
+                auto delay = std::chrono::ceil<std::chrono::milliseconds>(std::chrono::nanoseconds(delayNs));
+                client->livenessTimer = shard.loop.timers().schedule(delay, [this, &shard, client] {
+                        client->livenessTimer = 0;
+                        scheduleLiveness(shard, client, checkLiveness(*client));
+                });
+        }
+
+        // Desconecta quem passou de idleTimeout sem enviar nada e manda ping a
+        // quem está quieto há heartbeat. Retorna em quantos ns verificar de novo
+        // (-1: conexão encerrada). Chamado pela thread dona do cliente (threads) ou do shard
+        int64_t checkLiveness(ClientInfo& client) {
+                if (client.closing) {
+                        return -1;
+                }
+
+                int64_t now = steadyNs();
+                int64_t lastActivity = client.lastActivityNs.load(std::memory_order_relaxed);
+                int64_t quiet = now - lastActivity;
+                if (idleTimeoutNs > 0 && quiet >= idleTimeoutNs) {
+                        disconnectIdle(client, quiet);
+                        return -1;
+                }
+
+                int64_t next = idleTimeoutNs > 0 ? idleTimeoutNs - quiet : INT64_MAX;
+                if (heartbeatNs > 0) {
+                        int64_t sincePing = now - std::max(lastActivity, client.lastPingNs);
+                        if (sincePing >= heartbeatNs) {
+                                sendPing(client);
+                                client.lastPingNs = now;
+                                sincePing = 0;
+                        }
+                        next = std::min(next, heartbeatNs - sincePing);
+                }
+                return next;
+        }
+
+        // Texto: linha vazia (clientes ignoram ou respondem com outra); binário: quadro Ping
+        void sendPing(ClientInfo& client) {
+                static const SharedBuffer textPing = makeSharedBuffer("\n");
+                static const SharedBuffer framePing = encodeFrame(FrameType::Ping, 0, 0, {});
+
+                heartbeatsSent.add();
+                sendToClient(client, client.protocol == ClientProtocol::Binary ? framePing : textPing);
+        }
+
+        // Como o Disconnect por fila cheia: encerra o socket e a limpeza ocorre no caminho de leitura
+        void disconnectIdle(ClientInfo& client, int64_t quietNs) {
+                if (client.closing.exchange(true)) {
+                        return;
+                }
+                idleDisconnects.add();
+                logger.info(LogEvent::IdleDisconnected, client.clientId, quietNs / 1000000000);
+                ::shutdown(client.socket, SHUT_RDWR);
+        }
+
+        // Política Disconnect: encerra o socket; a limpeza ocorre no caminho de leitura
+        void disconnectSlowConsumer(ClientInfo& client) {
+                if (client.closing.exchange(true)) {
+                        return;
+                }
+                backpressure.disconnected++;
+                logger.warn(LogEvent::SlowConsumerDisconnected, client.clientId);
+                ::shutdown(client.socket, SHUT_RDWR);
         }
 };
 
-int main() {
+static ServerConfig parseArgs(int argc, char* argv[]) {
+        ServerConfig config;
+
+        for (int i = 1; i < argc; ++i) {
+                std::string arg = argv[i];
+
+                if (arg == "--mode=threads") {
+                        config.mode = ServerMode::Threads;
+                } else if (arg == "--mode=epoll") {
+                        config.mode = ServerMode::Epoll;
+                } else if (arg == "--mode=sharded") {
+                        config.mode = ServerMode::Sharded;
+                } else if (arg == "--mode=pool") {
+                        config.mode = ServerMode::Pool;
+                } else if (arg == "--mode=coro") {
+                        config.mode = ServerMode::Coro;
+                } else if (arg.rfind("--workers=", 0) == 0) {
+                        config.workers = static_cast<unsigned>(std::stoul(arg.substr(10)));
+                } else if (arg.rfind("--shards=", 0) == 0) {
+                        config.shards = static_cast<unsigned>(std::stoul(arg.substr(9)));
+                } else if (arg.rfind("--port=", 0) == 0) {
+                        config.port = std::stoi(arg.substr(7));
+                } else if (arg.rfind("--backlog=", 0) == 0) {
+                        config.backlog = std::stoi(arg.substr(10));
+                } else if (arg.rfind("--queue-limit=", 0) == 0) {
+                        config.queueLimit = std::stoul(arg.substr(14));
+                } else if (arg == "--slow-policy=drop-oldest") {
+                        config.slowPolicy = SlowConsumerPolicy::DropOldest;
+                } else if (arg == "--slow-policy=drop-new") {
+                        config.slowPolicy = SlowConsumerPolicy::DropNew;
+                } else if (arg == "--slow-policy=disconnect") {
+                        config.slowPolicy = SlowConsumerPolicy::Disconnect;
+                } else if (arg.rfind("--admin-port=", 0) == 0) {
+                        config.adminPort = std::stoi(arg.substr(13));
+                } else if (arg.rfind("--batch-us=", 0) == 0) {
+                        config.batchWindowUs = static_cast<unsigned>(std::stoul(arg.substr(11)));
+                } else if (arg.rfind("--batch-bytes=", 0) == 0) {
+                        config.batchMaxBytes = std::stoul(arg.substr(14));
+                } else if (arg.rfind("--history-dir=", 0) == 0) {
+                        config.historyDir = arg.substr(14);
+                } else if (arg.rfind("--history-sync-ms=", 0) == 0) {
+                        config.historySyncMs = static_cast<unsigned>(std::max(1ul, std::stoul(arg.substr(18))));
+                } else if (arg.rfind("--history-size=", 0) == 0) {
+                        config.historySize = std::max(1ul, std::stoul(arg.substr(15)));
+                } else if (arg.rfind("--max-rooms=", 0) == 0) {
+                        config.maxRooms = std::max(1ul, std::stoul(arg.substr(12)));
+                } else if (arg.rfind("--idle-timeout=", 0) == 0) {
+                        config.idleTimeoutSec = static_cast<unsigned>(std::stoul(arg.substr(15)));
+                } else if (arg.rfind("--heartbeat=", 0) == 0) {
+                        config.heartbeatSec = static_cast<unsigned>(std::stoul(arg.substr(12)));
+                } else if (arg.rfind("--log-level=", 0) == 0 && parseLogLevel(arg.substr(12), config.logLevel)) {
+                        continue;
+                } else {
+                        throw std::invalid_argument("argumento desconhecido '" + arg +
+                                                    "' (uso: tcp_server [--mode=threads|epoll|sharded|pool|coro] [--shards=N] [--workers=N] [--port=N] [--backlog=N]"
+                                                    " [--queue-limit=N] [--slow-policy=drop-oldest|drop-new|disconnect]"
+                                                    " [--log-level=debug|info|warn|error] [--admin-port=N]"
+                                                    " [--batch-us=N] [--batch-bytes=N] [--history-dir=DIR] [--history-sync-ms=N] [--history-size=N] [--max-rooms=N]"
+                                                    " [--idle-timeout=S] [--heartbeat=S])");
+                }
+        }
+
+        return config;
+}
+
+int main(int argc, char* argv[]) {
         try {
-                TCPChatServer server(8080);
+                TCPChatServer server(parseArgs(argc, argv));
                 server.start();
         } catch (const std::exception& e) {
                 std::cerr << "Erro fatal: " << e.what() << std::endl;
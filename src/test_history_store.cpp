@@ -0,0 +1,121 @@
+#include "../lib/history_store.h"
+#include "../lib/message_history.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Recuperação do log durável: um registro rasgado no fim do segmento é
+// cortado, o histórico volta inteiro e as sequências continuam de onde pararam
+
+static int failures = 0;
+
+static void check(bool ok, const std::string& what) {
+        std::printf("%s %s\n", ok ? "✅" : "❌", what.c_str());
+        if (!ok) {
+                failures++;
+        }
+}
+
+static std::string messageText(uint64_t i) {
+        return "Cliente 7: mensagem " + std::to_string(i);
+}
+
+static off_t fileSize(const std::string& path) {
+        struct stat info;
+        return stat(path.c_str(), &info) == 0 ? info.st_size : -1;
+}
+
+// Abre a sala 'sala' no diretório e recarrega o histórico
+static void openRoom(HistoryJournal& journal, MessageHistory& history) {
+        journal.open("sala", [&](const std::shared_ptr<HistoryStore>& store) { history.attachStore(store); });
+}
+
+// As linhas recuperadas têm sequências 1..count, na ordem, com o texto certo
+static bool contiguous(const MessageHistory& history, uint64_t count) {
+        HistorySlice slice = history.since(0);
+        if (slice.lines.size() != count || slice.last != count) {
+                return false;
+        }
+        for (uint64_t i = 0; i < count; ++i) {
+                const HistoryLine& line = slice.lines[i];
+                std::string expected = messageText(i + 1);
+                if (line.sequence != i + 1 || line.text.size() < expected.size() ||
+                    line.text.compare(line.text.size() - expected.size(), expected.size(), expected) != 0) {
+                        return false;
+                }
+        }
+        return true;
+}
+
+int main() {
+        char templ[] = "/tmp/history_store_test_XXXXXX";
+        if (!mkdtemp(templ)) {
+                std::perror("mkdtemp");
+                return 1;
+        }
+        const std::string directory = templ;
+        const std::string segment = directory + "/sala/0000000000000001.seg";
+        const std::chrono::milliseconds interval(5);
+
+        // 1) Grava 30 mensagens; o destrutor do journal faz a última rodada
+        {
+                HistoryJournal journal(directory, interval);
+                MessageHistory history(100);
+                openRoom(journal, history);
+                for (uint64_t i = 1; i <= 30; ++i) {
+                        history.addMessage(messageText(i), -1);
+                }
+        }
+        off_t intact = fileSize(segment);
+        check(intact > 0, "segmento gravado (" + std::to_string(intact) + " bytes)");
+
+        // 2) Simula queda no meio de uma escrita: meio registro no fim do segmento
+        {
+                int fd = open(segment.c_str(), O_WRONLY | O_APPEND);
+                const char torn[] = "HSTR\x40\x00\x00\x00parcial";
+                bool written = fd >= 0 && write(fd, torn, sizeof(torn) - 1) == static_cast<ssize_t>(sizeof(torn) - 1);
+                if (fd >= 0) {
+                        close(fd);
+                }
+                check(written, "registro rasgado acrescentado");
+        }
+
+        // 3) Recupera, confere o corte e continua a numeração
+        {
+                HistoryJournal journal(directory, interval);
+                MessageHistory history(100);
+                openRoom(journal, history);
+                check(fileSize(segment) == intact, "fim rasgado cortado do segmento");
+                check(contiguous(history, 30), "30 mensagens recuperadas em ordem");
+
+                uint64_t first = history.addMessage(makeSharedBuffer(messageText(31) + "\n"), -1);
+                check(first == 31, "sequência continua depois da recuperação (" + std::to_string(first) + ")");
+                for (uint64_t i = 32; i <= 35; ++i) {
+                        history.addMessage(messageText(i), -1);
+                }
+        }
+
+        // 4) Uma segunda partida vê as mensagens de antes e de depois do corte
+        {
+                HistoryJournal journal(directory, interval);
+                MessageHistory history(100);
+                openRoom(journal, history);
+                check(contiguous(history, 35), "35 mensagens recuperadas sem buracos depois do reinício");
+                check(history.lastSequence() == 35, "última sequência é 35");
+        }
+
+        std::string cleanup = "rm -rf '" + directory + "'";
+        if (std::system(cleanup.c_str()) != 0) {
+                std::printf("⚠️  Não removeu %s\n", directory.c_str());
+        }
+
+        if (failures > 0) {
+                std::printf("❌ %d verificação(ões) falharam\n", failures);
+                return 1;
+        }
+        std::printf("✅ Log durável do histórico OK\n");
+        return 0;
+}
@@ -0,0 +1,235 @@
+#include "../lib/message_history.h"
+#include "../lib/search_index.h"
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Busca do histórico (/search) contra uma varredura direta da janela guardada:
+// depois de descartes, na recuperação do log e com consultas de vários termos
+
+static int failures = 0;
+
+static void check(bool ok, const std::string& what) {
+        std::printf("%s %s\n", ok ? "✅" : "❌", what.c_str());
+        if (!ok) {
+                failures++;
+        }
+}
+
+// Tokens pela regra documentada em search_index.h, escrita de novo sem hash:
+// letras e dígitos ASCII (em minúsculas) e bytes UTF-8, só os primeiros MAX_TOKEN_BYTES
+static std::vector<std::string> referenceTokens(std::string_view text) {
+        std::vector<std::string> tokens;
+        std::string token;
+        auto flush = [&] {
+                if (!token.empty()) {
+                        tokens.push_back(token.substr(0, SearchIndex::MAX_TOKEN_BYTES));
+                        token.clear();
+                }
+        };
+        for (unsigned char c : text) {
+                if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80) {
+                        token += static_cast<char>(c);
+                } else if (c >= 'A' && c <= 'Z') {
+                        token += static_cast<char>(c - 'A' + 'a');
+                } else {
+                        flush();
+                }
+        }
+        flush();
+        return tokens;
+}
+
+static bool contains(const std::vector<std::string>& tokens, const std::string& token) {
+        for (const auto& t : tokens) {
+                if (t == token) {
+                        return true;
+                }
+        }
+        return false;
+}
+
+// Mensagem guardada pelo teste: sequência e texto sem o prefixo "Cliente N: "
+struct Sent {
+        uint64_t sequence;
+        std::string text;
+};
+
+// Varredura direta: as 'limit' mensagens mais novas da janela com todos os termos, em ordem
+static std::vector<uint64_t> bruteForce(const std::vector<Sent>& window, std::string_view query, size_t limit) {
+        std::vector<std::string> terms = referenceTokens(query);
+        std::vector<uint64_t> found;
+        for (auto it = window.rbegin(); it != window.rend() && found.size() < limit; ++it) {
+                std::vector<std::string> tokens = referenceTokens(it->text);
+                bool all = true;
+                for (const auto& term : terms) {
+                        all = all && contains(tokens, term);
+                }
+                if (all) {
+                        found.insert(found.begin(), it->sequence);
+                }
+        }
+        return found;
+}
+
+static const std::vector<std::string> WORDS = {
+        "ola", "Mundo", "MUNDO", "chat", "servidor", "ação", "AÇÃO", "café", "日本", "cliente",
+        "x1", "2024", "porta", "sala", "rede", "busca", "teste", "fim", "eco", "épico",
+};
+
+static std::string randomText(std::mt19937& random) {
+        static const char* SEPARATORS[] = {" ", ", ", "! ", " - ", "? "};
+        std::string text;
+        size_t count = 1 + random() % 6;
+        for (size_t i = 0; i < count; ++i) {
+                if (i > 0) {
+                        text += SEPARATORS[random() % 5];
+                }
+                text += WORDS[random() % WORDS.size()];
+        }
+        return text;
+}
+
+static std::string randomQuery(std::mt19937& random) {
+        std::string query = WORDS[random() % WORDS.size()];
+        size_t extra = random() % 3;
+        for (size_t i = 0; i < extra; ++i) {
+                query += " " + WORDS[random() % WORDS.size()];
+        }
+        return query;
+}
+
+// Compara /search com a varredura direta para um lote de consultas aleatórias
+static bool matchesBruteForce(const MessageHistory& history, const std::vector<Sent>& window, std::mt19937& random,
+                              size_t queries) {
+        std::vector<HistoryLine> lines;
+        for (size_t q = 0; q < queries; ++q) {
+                std::string query = randomQuery(random);
+                size_t limit = q % 2 == 0 ? 1000 : 1 + random() % 5;
+                if (!history.search(query, limit, lines)) {
+                        std::printf("   consulta sem termos: '%s'\n", query.c_str());
+                        return false;
+                }
+                std::vector<uint64_t> got;
+                for (const auto& line : lines) {
+                        got.push_back(line.sequence);
+                }
+                if (got != bruteForce(window, query, limit)) {
+                        std::printf("   divergência em '%s' (limite %zu): %zu resultados\n", query.c_str(), limit,
+                                    got.size());
+                        return false;
+                }
+        }
+        return true;
+}
+
+static std::vector<Sent> tail(const std::vector<Sent>& sent, size_t count) {
+        size_t start = sent.size() > count ? sent.size() - count : 0;
+        return std::vector<Sent>(sent.begin() + start, sent.end());
+}
+
+static void tokenization() {
+        std::vector<uint64_t> a;
+        std::vector<uint64_t> b;
+        SearchIndex::tokenize("Olá, MUNDO! olá", a);
+        SearchIndex::tokenize("mundo olá", b);
+        check(a == b && a.size() == 2, "ASCII sem diferenciar maiúsculas; token repetido conta uma vez");
+
+        SearchIndex::tokenize("AÇÃO", a);
+        SearchIndex::tokenize("ação", b);
+        check(a != b, "bytes UTF-8 entram como estão (sem minúsculas fora do ASCII)");
+
+        SearchIndex::tokenize("--- !!! ...", a);
+        check(a.empty(), "só separadores: nenhum token");
+
+        std::string prefix(SearchIndex::MAX_TOKEN_BYTES, 'a');
+        SearchIndex::tokenize(prefix + "xyz", a);
+        SearchIndex::tokenize(prefix + "qrs", b);
+        check(a == b, "só os primeiros MAX_TOKEN_BYTES de um token contam");
+}
+
+static void evictionAndQueries() {
+        const size_t window = 50;
+        MessageHistory history(window);
+        std::mt19937 random(42);
+        std::vector<Sent> sent;
+
+        bool ok = true;
+        for (size_t i = 0; i < 600 && ok; ++i) {
+                std::string text = randomText(random);
+                uint64_t sequence = history.addMessage(
+                        makeSharedBuffer("Cliente " + std::to_string(i % 7) + ": " + text + "\n"), -1);
+                sent.push_back(Sent{sequence, text});
+                if (i % 25 == 24) {
+                        ok = matchesBruteForce(history, tail(sent, window), random, 40);
+                }
+        }
+        check(ok, "/search igual à varredura da janela depois de 550 descartes");
+
+        std::vector<HistoryLine> lines;
+        history.search("cliente", 1000, lines);
+        check(lines.size() == bruteForce(tail(sent, window), "cliente", 1000).size(),
+              "prefixo 'Cliente N: ' fora do índice");
+        check(!history.search("... !!!", 10, lines), "consulta sem termos é recusada");
+}
+
+static void recoveryRebuild() {
+        char templ[] = "/tmp/search_index_test_XXXXXX";
+        if (!mkdtemp(templ)) {
+                check(false, "diretório temporário para o log");
+                return;
+        }
+        const std::string directory = templ;
+        const size_t window = 40;
+        std::mt19937 random(7);
+        std::vector<Sent> sent;
+
+        {
+                HistoryJournal journal(directory, std::chrono::milliseconds(5));
+                MessageHistory history(window);
+                journal.open("sala", [&](const std::shared_ptr<HistoryStore>& store) { history.attachStore(store); });
+                for (size_t i = 0; i < 150; ++i) {
+                        std::string text = randomText(random);
+                        uint64_t sequence = history.addMessage(makeSharedBuffer("Cliente 3: " + text + "\n"), -1);
+                        sent.push_back(Sent{sequence, text});
+                }
+        }
+
+        {
+                HistoryJournal journal(directory, std::chrono::milliseconds(5));
+                MessageHistory history(window);
+                journal.open("sala", [&](const std::shared_ptr<HistoryStore>& store) { history.attachStore(store); });
+                check(history.size() == window, "janela recuperada do log (" + std::to_string(history.size()) + ")");
+                check(matchesBruteForce(history, tail(sent, window), random, 200),
+                      "índice refeito na recuperação igual à varredura");
+
+                for (size_t i = 0; i < 60; ++i) {
+                        std::string text = randomText(random);
+                        uint64_t sequence = history.addMessage(makeSharedBuffer("Cliente 3: " + text + "\n"), -1);
+                        sent.push_back(Sent{sequence, text});
+                }
+                check(matchesBruteForce(history, tail(sent, window), random, 200),
+                      "descartes depois da recuperação mantêm o índice certo");
+        }
+
+        std::string cleanup = "rm -rf '" + directory + "'";
+        if (std::system(cleanup.c_str()) != 0) {
+                std::printf("⚠️  Não removeu %s\n", directory.c_str());
+        }
+}
+
+int main() {
+        tokenization();
+        evictionAndQueries();
+        recoveryRebuild();
+
+        if (failures > 0) {
+                std::printf("❌ %d verificação(ões) falharam\n", failures);
+                return 1;
+        }
+        std::printf("✅ Índice de busca OK\n");
+        return 0;
+}
@@ -0,0 +1,165 @@
+#include "../lib/timer_wheel.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Roda de temporizadores com tempo simulado: os instantes passados a
+// schedule()/advance() são relativos a 'base', sem dormir
+
+using Clock = TimerWheel::Clock;
+using std::chrono::milliseconds;
+
+static int failures = 0;
+
+static void check(bool ok, const std::string& what) {
+        std::printf("%s %s\n", ok ? "✅" : "❌", what.c_str());
+        if (!ok) {
+                failures++;
+        }
+}
+
+static std::string join(const std::vector<int>& values) {
+        std::string text;
+        for (int value : values) {
+                text += (text.empty() ? "" : ",") + std::to_string(value);
+        }
+        return text;
+}
+
+// Prazos diferentes no nível 0 disparam em ordem de vencimento, nunca antes
+static void orderWithinLevel() {
+        TimerWheel wheel(milliseconds(10));
+        Clock::time_point base = Clock::now();
+        std::vector<int> fired;
+        for (int delay : {50, 10, 30, 20, 40}) {
+                wheel.schedule(milliseconds(delay), [&fired, delay] { fired.push_back(delay); }, base);
+        }
+
+        wheel.advance(base + milliseconds(5));
+        check(fired.empty(), "nada dispara antes do primeiro prazo");
+        size_t count = wheel.advance(base + milliseconds(100));
+        check(count == 5 && join(fired) == "10,20,30,40,50", "nível 0 em ordem de vencimento: " + join(fired));
+        check(wheel.size() == 0 && wheel.timeoutMs(base + milliseconds(100)) == -1, "roda vazia depois dos disparos");
+}
+
+// Prazos em níveis diferentes disparam em ordem, mesmo numa única chamada
+static void orderAcrossLevels() {
+        TimerWheel wheel(milliseconds(10));
+        Clock::time_point base = Clock::now();
+        std::vector<int> fired;
+        // 1 tick (nível 0), 70 e 500 ticks (nível 1), 5000 ticks (nível 2), 300000 ticks (nível 3)
+        for (int delay : {3000000, 50000, 5, 5000, 700}) {
+                wheel.schedule(milliseconds(delay), [&fired, delay] { fired.push_back(delay); }, base);
+        }
+
+        size_t count = wheel.advance(base + milliseconds(3000010));
+        check(count == 5 && join(fired) == "5,700,5000,50000,3000000",
+              "níveis 0 a 3 em ordem de vencimento: " + join(fired));
+}
+
+// Avançando 1 ms por vez, cada prazo além do nível 0 desce pela cascata e
+// dispara no primeiro tick depois do prazo: nem antes, nem um tick atrasado
+static void cascadeTiming() {
+        const milliseconds tick(10);
+        const std::vector<int> delays = {700, 5000, 50000, 2700000};
+        TimerWheel wheel(tick);
+        Clock::time_point base = Clock::now();
+        std::vector<Clock::time_point> firedAt(delays.size());
+        Clock::time_point now = base;
+        for (size_t i = 0; i < delays.size(); ++i) {
+                wheel.schedule(milliseconds(delays[i]), [&firedAt, &now, i] { firedAt[i] = now; }, base);
+        }
+
+        while (wheel.size() > 0 && now < base + milliseconds(delays.back()) + tick * 2) {
+                now += milliseconds(1);
+                wheel.advance(now);
+        }
+
+        for (size_t i = 0; i < delays.size(); ++i) {
+                Clock::time_point deadline = base + milliseconds(delays[i]);
+                bool onTime = firedAt[i] >= deadline && firedAt[i] <= deadline + tick + milliseconds(1);
+                auto late = std::chrono::duration_cast<milliseconds>(firedAt[i] - deadline).count();
+                check(onTime, "prazo de " + std::to_string(delays[i]) + " ms disparou " + std::to_string(late) +
+                                      " ms depois do prazo");
+        }
+}
+
+// Uma chamada depois de muito tempo parado dispara o que venceu e deixa a
+// roda no tick certo para os próximos agendamentos
+static void longIdleGap() {
+        TimerWheel wheel(milliseconds(10));
+        Clock::time_point base = Clock::now();
+        std::vector<int> fired;
+        wheel.schedule(milliseconds(3000), [&fired] { fired.push_back(3000); }, base);
+        wheel.schedule(milliseconds(100), [&fired] { fired.push_back(100); }, base);
+        // Além do alcance da roda (~46 h): estaciona no último nível e desce depois
+        wheel.schedule(std::chrono::hours(50), [&fired] { fired.push_back(-1); }, base);
+
+        Clock::time_point later = base + std::chrono::hours(1);
+        size_t count = wheel.advance(later);
+        check(count == 2 && join(fired) == "100,3000", "intervalo de 1 h dispara o que venceu: " + join(fired));
+
+        fired.clear();
+        wheel.schedule(milliseconds(20), [&fired] { fired.push_back(20); }, later);
+        int timeout = wheel.timeoutMs(later);
+        check(timeout > 0 && timeout <= 30, "próximo disparo em " + std::to_string(timeout) + " ms depois do intervalo");
+        wheel.advance(later + milliseconds(10));
+        check(fired.empty(), "agendamento depois do intervalo não dispara adiantado");
+        wheel.advance(later + milliseconds(30));
+        check(join(fired) == "20", "agendamento depois do intervalo dispara no prazo");
+
+        fired.clear();
+        wheel.advance(base + std::chrono::hours(49));
+        check(fired.empty(), "prazo de 50 h não dispara com 49 h");
+        wheel.advance(base + std::chrono::hours(50) + milliseconds(10));
+        check(join(fired) == "-1" && wheel.size() == 0, "prazo de 50 h dispara depois de descer da posição estacionada");
+}
+
+// Um callback cancela outro temporizador do mesmo tick: só um dos dois roda,
+// e um temporizador novo criado no callback fica para um tick seguinte
+static void cancelDuringDispatch() {
+        TimerWheel wheel(milliseconds(10));
+        Clock::time_point base = Clock::now();
+        int runs = 0;
+        bool cancelled = false;
+        bool cancelledTwice = true;
+        bool rescheduledRan = false;
+        TimerWheel::TimerId first = 0;
+        TimerWheel::TimerId second = 0;
+        // O prazo de 20 ms arredonda para o tick seguinte: avança um tick além dele
+        Clock::time_point now = base + milliseconds(30);
+
+        auto body = [&](TimerWheel::TimerId* other) {
+                runs++;
+                cancelled = wheel.cancel(*other);
+                cancelledTwice = wheel.cancel(*other);
+                // Reaproveita o nó liberado pelo cancelamento
+                wheel.schedule(milliseconds(0), [&] { rescheduledRan = true; }, now);
+        };
+        first = wheel.schedule(milliseconds(20), [&] { body(&second); }, base);
+        second = wheel.schedule(milliseconds(20), [&] { body(&first); }, base);
+        wheel.schedule(milliseconds(20), [&] { runs += 100; }, base);
+
+        size_t count = wheel.advance(now);
+        check(runs == 101 && count == 2, "cancelado no mesmo tick não dispara (" + std::to_string(count) + " disparos)");
+        check(cancelled && !cancelledTwice, "cancel() vale uma vez só para o mesmo id");
+        check(!rescheduledRan && wheel.size() == 1, "agendado no callback fica para o próximo tick");
+        wheel.advance(now + milliseconds(10));
+        check(rescheduledRan && wheel.size() == 0, "agendado no callback dispara no tick seguinte");
+        check(!wheel.cancel(first) && !wheel.cancel(second), "ids já disparados ou cancelados não valem mais");
+}
+
+int main() {
+        orderWithinLevel();
+        orderAcrossLevels();
+        cascadeTiming();
+        longIdleGap();
+        cancelDuringDispatch();
+
+        if (failures > 0) {
+                std::printf("❌ %d verificação(ões) falharam\n", failures);
+                return 1;
+        }
+        std::printf("✅ Roda de temporizadores OK\n");
+        return 0;
+}
@@ -0,0 +1,212 @@
+#include "../lib/timer_wheel.h"
+#include <algorithm>
+#include <bit>
+#include <climits>
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tickLength)
+    : tick(std::max<Clock::duration>(tickLength, std::chrono::milliseconds(1))), origin(Clock::now()) {
+        heads.fill(NIL);
+}
+
+uint64_t TimerWheel::tickOf(Clock::time_point time) const {
+        return time <= origin ? 0 : static_cast<uint64_t>((time - origin) / tick);
+}
+
+TimerWheel::TimerId TimerWheel::schedule(std::chrono::milliseconds delay, Callback callback, Clock::time_point now) {
+        uint32_t index;
+        if (freeNodes.empty()) {
+                index = static_cast<uint32_t>(nodes.size());
+                nodes.emplace_back();
+        } else {
+                index = freeNodes.back();
+                freeNodes.pop_back();
+        }
+
+        // Arredonda para cima: nunca dispara antes do prazo
+        Clock::duration until = (now - origin) + std::max<Clock::duration>(delay, Clock::duration::zero());
+        uint64_t expiry = static_cast<uint64_t>((until + tick - Clock::duration(1)) / tick);
+
+        Node& node = nodes[index];
+        node.callback = std::move(callback);
+        node.expiry = std::max(expiry, current + 1);
+        insert(index);
+        active++;
+
+        return (static_cast<uint64_t>(node.generation) << 32) | (index + 1);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+        uint64_t slot = id & 0xffffffffu;
+        if (slot == 0 || slot > nodes.size()) {
+                return false;
+        }
+
+        uint32_t index = static_cast<uint32_t>(slot - 1);
+        Node& node = nodes[index];
+        if (node.generation != static_cast<uint32_t>(id >> 32) || node.bucket == NIL) {
+                return false;
+        }
+
+        // No lote sendo disparado o nó já saiu das listas; basta liberá-lo
+        if (node.bucket != DUE) {
+                unlink(index);
+        }
+        release(index);
+        active--;
+        return true;
+}
+
+// Nível pelo quanto falta; posição pelos bits do vencimento naquele nível.
+// A distância máxima de cada nível garante no máximo uma volta à frente
+void TimerWheel::insert(uint32_t index) {
+        Node& node = nodes[index];
+        uint64_t delta = node.expiry > current ? node.expiry - current : 0;
+
+        size_t level = 0;
+        while (level + 1 < LEVELS && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+                level++;
+        }
+
+        // Além do alcance do último nível: estaciona no ponto mais distante e desce de novo depois
+        uint64_t at = node.expiry;
+        uint64_t reach = uint64_t(1) << (SLOT_BITS * LEVELS);
+        if (delta >= reach) {
+                at = current + reach - 1;
+        }
+
+        size_t position = (at >> (SLOT_BITS * level)) & (SLOTS - 1);
+        uint32_t bucket = static_cast<uint32_t>(level * SLOTS + position);
+
+        node.bucket = bucket;
+        node.prev = NIL;
+        node.next = heads[bucket];
+        if (node.next != NIL) {
+                nodes[node.next].prev = index;
+        }
+        heads[bucket] = index;
+        occupied[level] |= uint64_t(1) << position;
+}
+
+void TimerWheel::unlink(uint32_t index) {
+        Node& node = nodes[index];
+        if (node.prev != NIL) {
+                nodes[node.prev].next = node.next;
+        } else {
+                heads[node.bucket] = node.next;
+                if (node.next == NIL) {
+                        occupied[node.bucket / SLOTS] &= ~(uint64_t(1) << (node.bucket % SLOTS));
+                }
+        }
+        if (node.next != NIL) {
+                nodes[node.next].prev = node.prev;
+        }
+        node.prev = NIL;
+        node.next = NIL;
+}
+
+void TimerWheel::release(uint32_t index) {
+        Node& node = nodes[index];
+        node.callback = nullptr;
+        node.bucket = NIL;
+        node.generation++;
+        freeNodes.push_back(index);
+}
+
+// Para cada nível ocupado, a próxima posição com temporizadores depois da
+// atual (pelo mapa de bits); no nível 0 é o tick do disparo, nos demais o da cascata
+uint64_t TimerWheel::ticksToNext() const {
+        uint64_t best = UINT64_MAX;
+        for (size_t level = 0; level < LEVELS; ++level) {
+                if (!occupied[level]) {
+                        continue;
+                }
+
+                unsigned shift = SLOT_BITS * static_cast<unsigned>(level);
+                uint64_t block = current >> shift;
+                unsigned position = static_cast<unsigned>(block & (SLOTS - 1));
+                // Bit k do giro = posição (position + 1 + k): distância k + 1
+                uint64_t rotated = std::rotr(occupied[level], static_cast<int>((position + 1) % SLOTS));
+                uint64_t distance = static_cast<uint64_t>(std::countr_zero(rotated)) + 1;
+
+                uint64_t ticks = ((block + distance) << shift) - current;
+                best = std::min(best, ticks);
+        }
+        return best;
+}
+
+// Redistribui a posição que o nível 'level' acabou de alcançar
+void TimerWheel::cascade(size_t level) {
+        size_t position = (current >> (SLOT_BITS * level)) & (SLOTS - 1);
+        uint32_t bucket = static_cast<uint32_t>(level * SLOTS + position);
+
+        uint32_t index = heads[bucket];
+        heads[bucket] = NIL;
+        occupied[level] &= ~(uint64_t(1) << position);
+
+        while (index != NIL) {
+                uint32_t next = nodes[index].next;
+                insert(index);
+                index = next;
+        }
+}
+
+size_t TimerWheel::advance(Clock::time_point now) {
+        uint64_t target = tickOf(now);
+        size_t fired = 0;
+
+        while (current < target && active > 0) {
+                // Pula direto os ticks sem disparo nem cascata
+                uint64_t skip = ticksToNext();
+                if (skip > target - current) {
+                        break;
+                }
+                current += skip;
+
+                for (size_t level = LEVELS - 1; level > 0; --level) {
+                        if ((current & ((uint64_t(1) << (SLOT_BITS * level)) - 1)) == 0) {
+                                cascade(level);
+                        }
+                }
+
+                // Separa o lote antes de disparar: callbacks podem agendar e cancelar
+                uint32_t bucket = static_cast<uint32_t>(current & (SLOTS - 1));
+                due.clear();
+                for (uint32_t index = heads[bucket]; index != NIL; index = nodes[index].next) {
+                        due.push_back(index);
+                }
+                heads[bucket] = NIL;
+                occupied[0] &= ~(uint64_t(1) << bucket);
+                for (uint32_t index : due) {
+                        nodes[index].bucket = DUE;
+                }
+
+                for (size_t i = 0; i < due.size(); ++i) {
+                        uint32_t index = due[i];
+                        if (nodes[index].bucket != DUE) {
+                                continue; // cancelado por um callback anterior do lote
+                        }
+                        Callback callback = std::move(nodes[index].callback);
+                        release(index);
+                        active--;
+                        callback();
+                        fired++;
+                }
+        }
+
+        current = std::max(current, target);
+        return fired;
+}
+
+int TimerWheel::timeoutMs(Clock::time_point now) const {
+        uint64_t ticks = ticksToNext();
+        if (ticks == UINT64_MAX) {
+                return -1;
+        }
+
+        Clock::time_point wake = origin + tick * static_cast<int64_t>(current + ticks);
+        if (wake <= now) {
+                return 0;
+        }
+        auto ms = std::chrono::ceil<std::chrono::milliseconds>(wake - now).count();
+        return static_cast<int>(std::min<int64_t>(ms, INT_MAX));
+}
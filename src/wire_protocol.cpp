@@ -0,0 +1,56 @@
+#include "../lib/wire_protocol.h"
+#include <cstring>
+#include <endian.h>
+
+// Escreve o quadro em out (FRAME_HEADER_SIZE + payload.size() bytes)
+static void encodeFrameInto(char* out, FrameType type, uint64_t sequence, uint32_t senderId, std::string_view payload) {
+        uint32_t length = htobe32(static_cast<uint32_t>(payload.size()));
+        uint64_t seq = htobe64(sequence);
+        uint32_t sender = htobe32(senderId);
+
+        std::memcpy(out, &length, 4);
+        out[4] = static_cast<char>(type);
+        out[5] = 0; // flags
+        out[6] = out[7] = 0; // reservados
+        std::memcpy(out + 8, &seq, 8);
+        std::memcpy(out + 16, &sender, 4);
+        std::memcpy(out + FRAME_HEADER_SIZE, payload.data(), payload.size());
+}
+
+SharedBuffer encodeFrame(FrameType type, uint64_t sequence, uint32_t senderId, std::string_view payload) {
+        return SharedBuffer::build(FRAME_HEADER_SIZE + payload.size(), [&](char* out) {
+                encodeFrameInto(out, type, sequence, senderId, payload);
+        });
+}
+
+DecodeStatus decodeFrame(std::string_view data, FrameHeader& header, std::string_view& payload, size_t& consumed) {
+        if (data.size() < FRAME_HEADER_SIZE) {
+                return DecodeStatus::Incomplete;
+        }
+
+        const char* in = data.data();
+        uint32_t length;
+        uint64_t seq;
+        uint32_t sender;
+        std::memcpy(&length, in, 4);
+        std::memcpy(&seq, in + 8, 8);
+        std::memcpy(&sender, in + 16, 4);
+
+        header.length = be32toh(length);
+        header.type = static_cast<FrameType>(in[4]);
+        header.flags = static_cast<uint8_t>(in[5]);
+        header.sequence = be64toh(seq);
+        header.senderId = be32toh(sender);
+
+        if (header.length > MAX_FRAME_PAYLOAD) {
+                return DecodeStatus::Invalid;
+        }
+
+        if (data.size() < FRAME_HEADER_SIZE + header.length) {
+                return DecodeStatus::Incomplete;
+        }
+
+        payload = data.substr(FRAME_HEADER_SIZE, header.length);
+        consumed = FRAME_HEADER_SIZE + header.length;
+        return DecodeStatus::Complete;
+}
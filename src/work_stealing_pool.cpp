@@ -0,0 +1,144 @@
+#include "../lib/work_stealing_pool.h"
+#include <algorithm>
+
+// Worker atual (nullptr fora do pool): tarefas internas vão para a própria fila
+static thread_local const WorkStealingPool* currentPool = nullptr;
+static thread_local size_t currentWorker = 0;
+
+WorkStealingPool::WorkStealingPool(size_t count) {
+        if (count == 0) {
+                count = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+                workers.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < count; ++i) {
+                threads.emplace_back(&WorkStealingPool::run, this, i);
+        }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+        shutdown();
+}
+
+void WorkStealingPool::submit(Task task) {
+        size_t index = currentPool == this ? currentWorker
+                                           : nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+        // Conta antes de publicar: um worker que pega a tarefa logo após o push
+        // faria fetch_sub antes e o contador (size_t) passaria por SIZE_MAX
+        pending.fetch_add(1);
+        {
+                std::lock_guard<std::mutex> lock(workers[index]->mutex);
+                workers[index]->tasks.push_back(std::move(task));
+        }
+
+        // Par com run(): ou o worker vê pending > 0, ou nós vemos sleeping > 0
+        if (sleeping.load() > 0) {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                wakeup.notify_one();
+        }
+}
+
+void WorkStealingPool::shutdown() {
+        if (stopping.exchange(true)) {
+                return;
+        }
+
+        {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                wakeup.notify_all();
+        }
+
+        for (auto& t : threads) {
+                if (t.joinable() && t.get_id() != std::this_thread::get_id()) {
+                        t.join();
+                }
+        }
+}
+
+size_t WorkStealingPool::workerDepth(size_t index) const {
+        std::lock_guard<std::mutex> lock(workers[index]->mutex);
+        return workers[index]->tasks.size();
+}
+
+bool WorkStealingPool::popLocal(size_t index, Task& task) {
+        Worker& self = *workers[index];
+        std::lock_guard<std::mutex> lock(self.mutex);
+        if (self.tasks.empty()) {
+                return false;
+        }
+        task = std::move(self.tasks.front());
+        self.tasks.pop_front();
+        return true;
+}
+
+// Percorre os demais workers a partir do vizinho; rouba a tarefa mais recente
+bool WorkStealingPool::steal(size_t thief, Task& task) {
+        for (size_t offset = 1; offset < workers.size(); ++offset) {
+                Worker& victim = *workers[(thief + offset) % workers.size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.tasks.empty()) {
+                        task = std::move(victim.tasks.back());
+                        victim.tasks.pop_back();
+                        steals.fetch_add(1, std::memory_order_relaxed);
+                        return true;
+                }
+        }
+        return false;
+}
+
+void WorkStealingPool::run(size_t index) {
+        currentPool = this;
+        currentWorker = index;
+
+        Task task;
+        while (!stopping.load()) {
+                if (popLocal(index, task) || steal(index, task)) {
+                        pending.fetch_sub(1);
+                        task();
+                        task = nullptr; // libera capturas antes de dormir
+                        executed.fetch_add(1, std::memory_order_relaxed);
+                        continue;
+                }
+
+                std::unique_lock<std::mutex> lock(sleepMutex);
+                sleeping.fetch_add(1);
+                wakeup.wait(lock, [this] { return stopping.load() || pending.load() > 0; });
+                sleeping.fetch_sub(1);
+        }
+}
+
+void Strand::post(Task task) {
+        {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.push_back(std::move(task));
+                if (scheduled) {
+                        return; // o drain em andamento executará esta tarefa
+                }
+                scheduled = true;
+        }
+
+        auto self = shared_from_this();
+        pool.submit([self] { self->drain(); });
+}
+
+void Strand::drain() {
+        for (size_t i = 0; i < MAX_TASKS_PER_RUN; ++i) {
+                Task task;
+                {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (tasks.empty()) {
+                                scheduled = false;
+                                return;
+                        }
+                        task = std::move(tasks.front());
+                        tasks.pop_front();
+                }
+                task();
+        }
+
+        // Ainda há trabalho: volta para o fim da fila para não monopolizar o worker
+        auto self = shared_from_this();
+        pool.submit([self] { self->drain(); });
+}